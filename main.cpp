@@ -1,11 +1,34 @@
 #include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <limits>
+#include <functional>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <queue>
-#include <stack>
-#include <unordered_set>
 #include <unordered_map>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include <SFML/Graphics.hpp>
 #include "include/json.hpp"
 
@@ -20,107 +43,3289 @@ void setText(Text &text, float x, float y) {
     text.setPosition(Vector2f(x, y));
 }
 
+//Heap allocation counting for the benchmarks...configuring with -DCOUNT_ALLOCATIONS=ON replaces the global operator new
+//with one that counts every allocation. It's off by default since every allocation in the app, SFML's included,
+//would pay for it, and getAllocationCount() then always returns 0.
+#ifdef COUNT_ALLOCATIONS
+const bool countingAllocations = true;
+atomic<size_t> allocationCount{0};
+
+//kept out of line so the compiler doesn't see malloc() and free() paired with operator new and delete and warn about a
+//mismatch.
+#ifdef __GNUC__
+#define OUT_OF_LINE __attribute__((noinline))
+#else
+#define OUT_OF_LINE
+#endif
+
+OUT_OF_LINE void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* memory = malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+OUT_OF_LINE void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+OUT_OF_LINE void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+size_t getAllocationCount() {
+    return allocationCount.load(memory_order_relaxed);
+}
+#else
+const bool countingAllocations = false;
+
+size_t getAllocationCount() {
+    return 0;
+}
+#endif
+
+//" with N heap allocations" for the end of a timing line, or a note that they aren't counted in this build.
+string describeAllocations(size_t allocations) {
+    return countingAllocations ? " with " + to_string(allocations) + " heap allocations" : " (heap allocations not counted)";
+}
+
+//Process-wide string interning pool...each distinct string is copied once into large arena blocks and gets a
+//handle, and the string_views it hands out stay valid until the program exits.
+//Strings are only interned while loading, so the pool doesn't lock...lookups from several threads are fine
+//as long as nothing is being interned at the same time.
+class StringPool {
+private:
+    static constexpr size_t blockSize = 1 << 16;
+    static constexpr uint32_t emptySlot = UINT32_MAX;
+
+    //arena blocks, filled one after another...strings longer than a block get an allocation of their own.
+    vector<unique_ptr<char[]>> blocks;
+    vector<unique_ptr<char[]>> largeStrings;
+    size_t blockUsed = 0;
+    size_t arenaBytes = 0;
+
+    //handle -> string and its hash.
+    vector<string_view> strings;
+    vector<size_t> hashes;
+
+    //open addressing hash table of handles, always a power of two in size.
+    vector<uint32_t> slots;
+
+    char* allocate(size_t size) {
+        if (size > blockSize) {
+            largeStrings.emplace_back(new char[size]);
+            arenaBytes += size;
+            return largeStrings.back().get();
+        }
+        if (blocks.empty() || blockUsed + size > blockSize) {
+            blocks.emplace_back(new char[blockSize]);
+            arenaBytes += blockSize;
+            blockUsed = 0;
+        }
+        char* memory = blocks.back().get() + blockUsed;
+        blockUsed += size;
+        return memory;
+    }
+
+    //doubles the hash table, reusing the stored hashes.
+    void grow() {
+        vector<uint32_t> newSlots(max<size_t>(slots.size() * 2, 1024), emptySlot);
+        size_t mask = newSlots.size() - 1;
+        for (uint32_t handle = 0; handle < strings.size(); ++handle) {
+            size_t slot = hashes[handle] & mask;
+            while (newSlots[slot] != emptySlot) {
+                slot = (slot + 1) & mask;
+            }
+            newSlots[slot] = handle;
+        }
+        slots.swap(newSlots);
+    }
+
+    //returns the slot holding the string, or the empty slot it would go in.
+    [[nodiscard]] size_t findSlot(string_view text, size_t hash) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = hash & mask;
+        while (slots[slot] != emptySlot && (hashes[slots[slot]] != hash || strings[slots[slot]] != text)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    //returns the handle for the string, copying it into the pool the first time it's seen.
+    uint32_t intern(string_view text) {
+        if ((strings.size() + 1) * 4 > slots.size() * 3) {
+            grow();
+        }
+        size_t hash = std::hash<string_view>()(text);
+        size_t slot = findSlot(text, hash);
+        if (slots[slot] == emptySlot) {
+            char* memory = allocate(text.size());
+            if (!text.empty()) {
+                memcpy(memory, text.data(), text.size());
+            }
+            slots[slot] = static_cast<uint32_t>(strings.size());
+            strings.emplace_back(memory, text.size());
+            hashes.push_back(hash);
+        }
+        return slots[slot];
+    }
+
+    //looks up a string without adding it...returns false if it was never interned.
+    bool find(string_view text, uint32_t& handle) const {
+        if (slots.empty()) {
+            return false;
+        }
+        size_t slot = findSlot(text, std::hash<string_view>()(text));
+        if (slots[slot] == emptySlot) {
+            return false;
+        }
+        handle = slots[slot];
+        return true;
+    }
+
+    [[nodiscard]] string_view get(uint32_t handle) const {
+        return strings[handle];
+    }
+
+    //number of distinct strings interned.
+    [[nodiscard]] size_t getCount() const {
+        return strings.size();
+    }
+
+    //bytes used by the arena blocks and the tables.
+    [[nodiscard]] size_t getMemoryUsage() const {
+        return arenaBytes + strings.capacity() * sizeof(string_view) + hashes.capacity() * sizeof(size_t) +
+               slots.capacity() * sizeof(uint32_t);
+    }
+};
+
+//the pool shared by the whole program.
+StringPool& getStringPool() {
+    static StringPool pool;
+    return pool;
+}
+
+//Artist fields used by the program, pulled out of each dataset record...the strings are views into the
+//string pool or the catalog and are never owned by the artist.
+struct Artist {
+    string_view id;
+    string_view name;
+    double familiarity = 0.0;
+    double hotttnesss = 0.0;
+    string_view genre;
+};
+
+//SAX handler that streams through the data set and only keeps the artist fields the program uses.
+//Song and release objects and every other artist field are skipped without ever being stored.
+class ArtistSaxHandler : public nlohmann::json_sax<json> {
+private:
+    //artist fields that are projected out of each record.
+    enum class Field { None, Id, Name, Familiarity, Hotttnesss, Terms };
+
+    vector<Artist>& artists;
+    StringPool& pool;
+
+    //called after every progressInterval kept artists so the loader can report how far it has got.
+    static constexpr size_t progressInterval = 4096;
+    function<void()> onProgress;
+
+    //seenIds[handle] is set once an artist with that interned ID has been kept.
+    vector<bool> seenIds;
+
+    //number of open objects/arrays...records sit at depth 2 and their artist object at depth 3.
+    int depth = 0;
+    bool recordKeyIsArtist = false;
+    bool inArtist = false;
+    Field currentField = Field::None;
+    Artist current;
+
+    //stores a number for the current artist field.
+    bool setNumber(double value) {
+        if (inArtist && depth == 3 && currentField == Field::Familiarity) {
+            current.familiarity = value;
+        } else if (inArtist && depth == 3 && currentField == Field::Hotttnesss) {
+            current.hotttnesss = value;
+        }
+        return true;
+    }
+
+public:
+    explicit ArtistSaxHandler(vector<Artist>& output, function<void()> progress = nullptr)
+        : artists(output), pool(getStringPool()), onProgress(move(progress)) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return setNumber(static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return setNumber(static_cast<double>(value)); }
+    bool number_float(number_float_t value, const string_t&) override { return setNumber(value); }
+    bool binary(binary_t&) override { return true; }
+
+    bool string(string_t& value) override {
+        if (inArtist && depth == 3) {
+            if (currentField == Field::Id) {
+                current.id = pool.get(pool.intern(value));
+            } else if (currentField == Field::Name) {
+                current.name = pool.get(pool.intern(value));
+            } else if (currentField == Field::Terms) {
+                current.genre = pool.get(pool.intern(value));
+            }
+        }
+        return true;
+    }
+
+    bool key(string_t& value) override {
+        if (depth == 2) {
+            recordKeyIsArtist = (value == "artist");
+        } else if (inArtist && depth == 3) {
+            if (value == "id") {
+                currentField = Field::Id;
+            } else if (value == "name") {
+                currentField = Field::Name;
+            } else if (value == "familiarity") {
+                currentField = Field::Familiarity;
+            } else if (value == "hotttnesss") {
+                currentField = Field::Hotttnesss;
+            } else if (value == "terms") {
+                currentField = Field::Terms;
+            } else {
+                currentField = Field::None;
+            }
+        }
+        return true;
+    }
+
+    bool start_object(size_t) override {
+        depth++;
+        if (depth == 3 && recordKeyIsArtist) {
+            inArtist = true;
+            current = Artist();
+            currentField = Field::None;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        //keeps the artist the first time its ID shows up.
+        if (inArtist && depth == 3) {
+            inArtist = false;
+            uint32_t handle = pool.intern(current.id);
+            if (handle >= seenIds.size()) {
+                seenIds.resize(max<size_t>(seenIds.size() * 2, handle + 1));
+            }
+            if (!seenIds[handle]) {
+                seenIds[handle] = true;
+                artists.push_back(current);
+                if (onProgress && artists.size() % progressInterval == 0) {
+                    onProgress();
+                }
+            }
+        }
+        depth--;
+        return true;
+    }
+
+    bool start_array(size_t) override {
+        depth++;
+        return true;
+    }
+
+    bool end_array() override {
+        depth--;
+        return true;
+    }
+
+    bool parse_error(size_t, const string_t&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+};
+
+//Hashes a block of bytes with 64-bit FNV-1a...used for snapshot checksums and source file hashes.
+uint64_t fnv1a(const char* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//Hashes a whole file in chunks...returns 0 if the file can't be read.
+uint64_t hashFile(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+    vector<char> chunk(1 << 20);
+    uint64_t hash = fnv1a(nullptr, 0);
+    while (file.read(chunk.data(), static_cast<streamsize>(chunk.size())) || file.gcount() > 0) {
+        hash = fnv1a(chunk.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    return hash;
+}
+
+//Read-only memory mapping of a whole file, so several running copies of the program share the same pages.
+//Windows builds just read the file into memory instead.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    //maps the file...returns false if it doesn't exist or is empty.
+    bool open(const string& path) {
+        close();
+#ifdef _WIN32
+        ifstream file(path, ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+        return size > 0;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<const char*>(mapping);
+        size = static_cast<size_t>(info.st_size);
+        return true;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        buffer.clear();
+#else
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    [[nodiscard]] const char* getData() const {
+        return data;
+    }
+
+    [[nodiscard]] size_t getSize() const {
+        return size;
+    }
+};
+
+//Binary snapshot of the catalog...a header followed by one column per artist field, the genre records,
+//genre member lists and the string pool, each section starting on an 8 byte boundary.
+//The snapshot is written in the machine's native byte order.
+const char snapshotMagic[8] = {'U', 'G', 'A', 'R', 'T', 'I', 'S', 'T'};
+const uint32_t snapshotVersion = 3;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t artistCount;
+    uint32_t genreCount;
+    uint32_t reserved;
+    uint64_t stringPoolSize;
+    //size, modification time and hash of the json file the snapshot was built from.
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint64_t sourceHash;
+    //hash of every byte after the header.
+    uint64_t checksum;
+};
+
+//Genre record...its artists are genreMembers[firstMember] to genreMembers[firstMember + memberCount - 1].
+//The similarity graph isn't stored...buildArtistGraph connects each genre's members again on every launch.
+struct GenreRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t firstMember;
+    uint32_t memberCount;
+};
+
+//Struct-of-arrays view of the catalog's artists...entry i of every column belongs to artist i.
+//Artist i's ID is strings[idOffsets[i]] to strings[idOffsets[i + 1] - 1], and the same goes for names.
+struct ArtistTable {
+    uint32_t count = 0;
+    const float* familiarity = nullptr;
+    const float* hotttnesss = nullptr;
+    const uint16_t* genre = nullptr;
+    const uint32_t* idOffsets = nullptr;
+    const uint32_t* nameOffsets = nullptr;
+    const char* strings = nullptr;
+
+    [[nodiscard]] string_view getId(uint32_t index) const {
+        return {strings + idOffsets[index], idOffsets[index + 1] - idOffsets[index]};
+    }
+
+    [[nodiscard]] string_view getName(uint32_t index) const {
+        return {strings + nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]};
+    }
+
+    //bytes of column data per artist, not counting the ID and name characters.
+    [[nodiscard]] static size_t getColumnBytesPerArtist() {
+        return 2 * sizeof(float) + sizeof(uint16_t) + 2 * sizeof(uint32_t);
+    }
+
+    //total bytes used by the columns and the ID and name characters.
+    [[nodiscard]] size_t getMemoryUsage() const {
+        if (count == 0) {
+            return 0;
+        }
+        return count * getColumnBytesPerArtist() + 2 * sizeof(uint32_t) + (nameOffsets[count] - idOffsets[0]);
+    }
+};
+
+//Most genres the snapshot can hold, since genre numbers are stored as 16 bit integers.
+const size_t maxGenreCount = 65536;
+
+//Byte offsets of each snapshot section, worked out from the counts in the header.
+struct SnapshotLayout {
+    size_t familiarity;
+    size_t hotttnesss;
+    size_t genre;
+    size_t idOffsets;
+    size_t nameOffsets;
+    size_t genres;
+    size_t genreMembers;
+    size_t strings;
+    size_t total;
+
+    explicit SnapshotLayout(const SnapshotHeader& header) {
+        auto align = [](size_t offset) { return (offset + 7) & ~static_cast<size_t>(7); };
+        size_t artists = header.artistCount;
+        familiarity = align(sizeof(SnapshotHeader));
+        hotttnesss = align(familiarity + artists * sizeof(float));
+        genre = align(hotttnesss + artists * sizeof(float));
+        idOffsets = align(genre + artists * sizeof(uint16_t));
+        nameOffsets = align(idOffsets + (artists + 1) * sizeof(uint32_t));
+        genres = align(nameOffsets + (artists + 1) * sizeof(uint32_t));
+        genreMembers = align(genres + header.genreCount * sizeof(GenreRecord));
+        strings = align(genreMembers + artists * sizeof(uint32_t));
+        total = strings + header.stringPoolSize;
+    }
+};
+
+//Read-only range of catalog indices, such as a genre's posting list.
+struct IndexRange {
+    const uint32_t* first;
+    const uint32_t* last;
+
+    [[nodiscard]] const uint32_t* begin() const {
+        return first;
+    }
+
+    [[nodiscard]] const uint32_t* end() const {
+        return last;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return static_cast<size_t>(last - first);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return first == last;
+    }
+};
+
+//Class for loading the data set once and answering every genre query from memory.
+//The catalog is a read-only view over a binary snapshot, which is either mapped straight from disk
+//or built from the json file when the snapshot is missing or out of date.
+class ArtistCatalog {
+private:
+    //snapshot bytes backing the catalog...never modified after loading.
+    MappedFile mappedSnapshot;
+    vector<char> builtSnapshot;
+    const SnapshotHeader* header = nullptr;
+    ArtistTable table;
+    const GenreRecord* genres = nullptr;
+    const uint32_t* genreMembers = nullptr;
+    const char* strings = nullptr;
+    size_t snapshotSize = 0;
+
+    //genre name -> genre number...each genre's posting list of artists is already in the snapshot.
+    unordered_map<string_view, uint32_t> genreIndex;
+
+    //every genre's posting list again, sorted from least to most familiar...laid out the same as genreMembers.
+    vector<uint32_t> nicheIndex;
+
+    double loadTime = 0.0;
+    double parseTime = 0.0;
+    size_t parsedFileSize = 0;
+    size_t loadAllocations = 0;
+    bool loadedFromSnapshot = false;
+
+    //size and modification time of the json file, used to spot stale snapshots without reading the file.
+    struct SourceInfo {
+        bool exists = false;
+        uint64_t size = 0;
+        int64_t modified = 0;
+    };
+
+    static SourceInfo getSourceInfo(const string& path) {
+        SourceInfo info;
+        error_code error;
+        auto size = filesystem::file_size(path, error);
+        if (error) {
+            return info;
+        }
+        auto modified = filesystem::last_write_time(path, error);
+        if (error) {
+            return info;
+        }
+        info.exists = true;
+        info.size = size;
+        info.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+        return info;
+    }
+
+    //checks the snapshot bytes and points the catalog at its sections...returns false if it's corrupt or from another version.
+    bool attach(const char* data, size_t size) {
+        header = nullptr;
+        if (data == nullptr || size < sizeof(SnapshotHeader)) {
+            return false;
+        }
+        auto candidate = reinterpret_cast<const SnapshotHeader*>(data);
+        if (!equal(begin(snapshotMagic), end(snapshotMagic), candidate->magic) || candidate->version != snapshotVersion) {
+            return false;
+        }
+        SnapshotLayout layout(*candidate);
+        if (layout.total != size || fnv1a(data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) != candidate->checksum) {
+            return false;
+        }
+
+        header = candidate;
+        table.count = header->artistCount;
+        table.familiarity = reinterpret_cast<const float*>(data + layout.familiarity);
+        table.hotttnesss = reinterpret_cast<const float*>(data + layout.hotttnesss);
+        table.genre = reinterpret_cast<const uint16_t*>(data + layout.genre);
+        table.idOffsets = reinterpret_cast<const uint32_t*>(data + layout.idOffsets);
+        table.nameOffsets = reinterpret_cast<const uint32_t*>(data + layout.nameOffsets);
+        table.strings = data + layout.strings;
+        genres = reinterpret_cast<const GenreRecord*>(data + layout.genres);
+        genreMembers = reinterpret_cast<const uint32_t*>(data + layout.genreMembers);
+        strings = data + layout.strings;
+        snapshotSize = size;
+
+        genreIndex.clear();
+        genreIndex.reserve(header->genreCount);
+        for (uint32_t genre = 0; genre < header->genreCount; ++genre) {
+            genreIndex.emplace(getString(genres[genre].nameOffset, genres[genre].nameLength), genre);
+        }
+        return true;
+    }
+
+    //a snapshot is stale once the json file changes...size and modification time are checked first
+    //and the file is only hashed if the modification time moved.
+    [[nodiscard]] bool matchesSource(const string& jsonPath, const SourceInfo& source) const {
+        if (!source.exists) {
+            return true;
+        }
+        if (header->sourceSize != source.size) {
+            return false;
+        }
+        return header->sourceModified == source.modified || header->sourceHash == hashFile(jsonPath);
+    }
+
+    //streams the json file through the SAX handler instead of building the whole json document in memory.
+    //parseProgress, if given, follows the read position through the file.
+    bool parseJson(const string& path, vector<Artist>& artists, atomic<float>* parseProgress) {
+        ifstream file(path, ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.seekg(0, ios::end);
+        parsedFileSize = static_cast<size_t>(file.tellg());
+        file.seekg(0, ios::beg);
+
+        auto start = chrono::high_resolution_clock::now();
+        function<void()> onProgress;
+        if (parseProgress != nullptr && parsedFileSize > 0) {
+            onProgress = [&file, parseProgress, this]() {
+                streamoff position = file.tellg();
+                if (position > 0) {
+                    parseProgress->store(static_cast<float>(position) / parsedFileSize, memory_order_relaxed);
+                }
+            };
+        }
+        ArtistSaxHandler handler(artists, onProgress);
+        bool parsed = json::sax_parse(file, &handler);
+        auto end = chrono::high_resolution_clock::now();
+        parseTime = chrono::duration<double, milli>(end - start).count();
+        return parsed;
+    }
+
+    //lays the parsed artists out in the snapshot format, one column per field, grouping artists by genre in data set order.
+    //Returns an empty buffer if there are too many genres to number with 16 bits.
+    static vector<char> buildSnapshot(const vector<Artist>& artists, const SourceInfo& source, uint64_t sourceHash) {
+        size_t count = artists.size();
+        unordered_map<string_view, uint16_t> genreIds;
+        vector<string_view> genreNames;
+        vector<uint32_t> memberCounts;
+
+        vector<float> familiarity(count);
+        vector<float> hotttnesss(count);
+        vector<uint16_t> genre(count);
+        vector<uint32_t> idOffsets(count + 1);
+        vector<uint32_t> nameOffsets(count + 1);
+        string pool;
+
+        //all IDs first and then all names, so each artist's string ends where the next one starts.
+        for (size_t i = 0; i < count; ++i) {
+            idOffsets[i] = static_cast<uint32_t>(pool.size());
+            pool += artists[i].id;
+        }
+        idOffsets[count] = static_cast<uint32_t>(pool.size());
+        for (size_t i = 0; i < count; ++i) {
+            nameOffsets[i] = static_cast<uint32_t>(pool.size());
+            pool += artists[i].name;
+        }
+        nameOffsets[count] = static_cast<uint32_t>(pool.size());
+
+        for (size_t i = 0; i < count; ++i) {
+            //looks the genre up before inserting, since emplace allocates a node even when the key is already there.
+            auto found = genreIds.find(artists[i].genre);
+            if (found == genreIds.end()) {
+                if (genreNames.size() == maxGenreCount) {
+                    return {};
+                }
+                found = genreIds.emplace(artists[i].genre, static_cast<uint16_t>(genreNames.size())).first;
+                genreNames.push_back(artists[i].genre);
+                memberCounts.push_back(0);
+            }
+            familiarity[i] = static_cast<float>(artists[i].familiarity);
+            hotttnesss[i] = static_cast<float>(artists[i].hotttnesss);
+            genre[i] = found->second;
+            memberCounts[genre[i]]++;
+        }
+
+        vector<GenreRecord> genreRecords(genreNames.size());
+        uint32_t firstMember = 0;
+        for (size_t g = 0; g < genreNames.size(); ++g) {
+            genreRecords[g].nameOffset = static_cast<uint32_t>(pool.size());
+            genreRecords[g].nameLength = static_cast<uint32_t>(genreNames[g].size());
+            pool += genreNames[g];
+            genreRecords[g].firstMember = firstMember;
+            genreRecords[g].memberCount = memberCounts[g];
+            firstMember += memberCounts[g];
+        }
+
+        vector<uint32_t> members(count);
+        vector<uint32_t> nextSlot(genreRecords.size());
+        for (size_t g = 0; g < genreRecords.size(); ++g) {
+            nextSlot[g] = genreRecords[g].firstMember;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            members[nextSlot[genre[i]]++] = static_cast<uint32_t>(i);
+        }
+
+        SnapshotHeader newHeader{};
+        copy(begin(snapshotMagic), end(snapshotMagic), newHeader.magic);
+        newHeader.version = snapshotVersion;
+        newHeader.artistCount = static_cast<uint32_t>(count);
+        newHeader.genreCount = static_cast<uint32_t>(genreRecords.size());
+        newHeader.stringPoolSize = pool.size();
+        newHeader.sourceSize = source.size;
+        newHeader.sourceModified = source.modified;
+        newHeader.sourceHash = sourceHash;
+
+        SnapshotLayout layout(newHeader);
+        vector<char> bytes(layout.total, 0);
+        memcpy(bytes.data() + layout.familiarity, familiarity.data(), count * sizeof(float));
+        memcpy(bytes.data() + layout.hotttnesss, hotttnesss.data(), count * sizeof(float));
+        memcpy(bytes.data() + layout.genre, genre.data(), count * sizeof(uint16_t));
+        memcpy(bytes.data() + layout.idOffsets, idOffsets.data(), (count + 1) * sizeof(uint32_t));
+        memcpy(bytes.data() + layout.nameOffsets, nameOffsets.data(), (count + 1) * sizeof(uint32_t));
+        memcpy(bytes.data() + layout.genres, genreRecords.data(), genreRecords.size() * sizeof(GenreRecord));
+        memcpy(bytes.data() + layout.genreMembers, members.data(), count * sizeof(uint32_t));
+        memcpy(bytes.data() + layout.strings, pool.data(), pool.size());
+        newHeader.checksum = fnv1a(bytes.data() + sizeof(SnapshotHeader), bytes.size() - sizeof(SnapshotHeader));
+        memcpy(bytes.data(), &newHeader, sizeof(SnapshotHeader));
+        return bytes;
+    }
+
+    //writes the snapshot next to a temporary name first so other processes never map a half-written file.
+    static bool writeSnapshot(const string& path, const vector<char>& bytes) {
+        string temporaryPath = path + ".tmp";
+        {
+            ofstream file(temporaryPath, ios::binary | ios::trunc);
+            if (!file.is_open() || !file.write(bytes.data(), static_cast<streamsize>(bytes.size()))) {
+                return false;
+            }
+        }
+        error_code error;
+        filesystem::rename(temporaryPath, path, error);
+        return !error;
+    }
+
+    [[nodiscard]] string_view getString(uint32_t offset, uint32_t length) const {
+        return {strings + offset, length};
+    }
+
+    //sorts a copy of each genre's posting list by familiarity, ties by catalog index, in O(n log n).
+    void buildNicheIndex() {
+        nicheIndex.assign(genreMembers, genreMembers + header->artistCount);
+        for (uint32_t genre = 0; genre < header->genreCount; ++genre) {
+            auto first = nicheIndex.begin() + genres[genre].firstMember;
+            sort(first, first + genres[genre].memberCount, [this](uint32_t a, uint32_t b) {
+                return table.familiarity[a] < table.familiarity[b] || (table.familiarity[a] == table.familiarity[b] && a < b);
+            });
+        }
+    }
+
+public:
+    ArtistCatalog() = default;
+    ArtistCatalog(const ArtistCatalog&) = delete;
+    ArtistCatalog& operator=(const ArtistCatalog&) = delete;
+
+    //maps the snapshot if it's valid and matches the json file, otherwise parses the json file a single time
+    //and writes a fresh snapshot for the next launch...returns false if neither can be read.
+    //progress, if given, goes from 0 to 1 as the load runs, so another thread can watch it.
+    bool load(const string& jsonPath, const string& snapshotPath, bool forceRebuild = false, atomic<float>* progress = nullptr) {
+        auto start = chrono::high_resolution_clock::now();
+        size_t allocationsBefore = getAllocationCount();
+        SourceInfo source = getSourceInfo(jsonPath);
+        parsedFileSize = 0;
+        parseTime = 0.0;
+
+        loadedFromSnapshot = !forceRebuild && mappedSnapshot.open(snapshotPath) &&
+                             attach(mappedSnapshot.getData(), mappedSnapshot.getSize()) && matchesSource(jsonPath, source);
+
+        if (loadedFromSnapshot && source.exists && header->sourceModified != source.modified) {
+            //the json file was touched but its contents match...saves the new modification time so it isn't hashed again next launch.
+            vector<char> restamped(mappedSnapshot.getData(), mappedSnapshot.getData() + mappedSnapshot.getSize());
+            reinterpret_cast<SnapshotHeader*>(restamped.data())->sourceModified = source.modified;
+            writeSnapshot(snapshotPath, restamped);
+        } else if (!loadedFromSnapshot) {
+            header = nullptr;
+            mappedSnapshot.close();
+
+            vector<Artist> artists;
+            if (!source.exists || !parseJson(jsonPath, artists, progress)) {
+                return false;
+            }
+            builtSnapshot = buildSnapshot(artists, source, hashFile(jsonPath));
+            //attach() rejects the empty buffer buildSnapshot returns when there are too many genres.
+            if (!attach(builtSnapshot.data(), builtSnapshot.size())) {
+                return false;
+            }
+            //the catalog still works from memory if the snapshot can't be saved.
+            writeSnapshot(snapshotPath, builtSnapshot);
+        }
+        buildNicheIndex();
+
+        auto end = chrono::high_resolution_clock::now();
+        loadTime = chrono::duration<double, milli>(end - start).count();
+        loadAllocations = getAllocationCount() - allocationsBefore;
+        if (progress != nullptr) {
+            progress->store(1.0f, memory_order_relaxed);
+        }
+        return true;
+    }
+
+    //column view of every artist...traversals read familiarity and names straight out of it.
+    [[nodiscard]] const ArtistTable& getTable() const {
+        return table;
+    }
+
+    //returns the artist at the given catalog index...its strings are views into the catalog, valid as long as it is loaded.
+    [[nodiscard]] Artist getArtist(uint32_t index) const {
+        return {table.getId(index), table.getName(index), table.familiarity[index], table.hotttnesss[index], getGenreName(table.genre[index])};
+    }
+
+    [[nodiscard]] float getFamiliarity(uint32_t index) const {
+        return table.familiarity[index];
+    }
+
+    [[nodiscard]] float getHotttnesss(uint32_t index) const {
+        return table.hotttnesss[index];
+    }
+
+    [[nodiscard]] string_view getArtistId(uint32_t index) const {
+        return table.getId(index);
+    }
+
+    //looks up a genre's number in the genre index...returns false if no artist has that genre.
+    bool findGenre(string_view name, uint32_t& genre) const {
+        auto found = genreIndex.find(name);
+        if (found == genreIndex.end()) {
+            return false;
+        }
+        genre = found->second;
+        return true;
+    }
+
+    //returns every artist whose genre (terms) matches the selected genre, viewing the catalog like getArtist.
+    [[nodiscard]] vector<Artist> getArtistsInGenre(const string& genre) const {
+        vector<Artist> matches;
+        uint32_t g;
+        if (findGenre(genre, g)) {
+            matches.reserve(getGenreSize(g));
+            for (uint32_t member : getGenreMembers(g)) {
+                matches.push_back(getArtist(member));
+            }
+        }
+        return matches;
+    }
+
+    [[nodiscard]] size_t getArtistCount() const {
+        return header == nullptr ? 0 : header->artistCount;
+    }
+
+    [[nodiscard]] uint32_t getGenreCount() const {
+        return header == nullptr ? 0 : header->genreCount;
+    }
+
+    [[nodiscard]] string_view getGenreName(uint32_t genre) const {
+        return getString(genres[genre].nameOffset, genres[genre].nameLength);
+    }
+
+    //number of artists in a genre.
+    [[nodiscard]] uint32_t getGenreSize(uint32_t genre) const {
+        return genres[genre].memberCount;
+    }
+
+    //number of artists in a genre looked up by name...0 if no artist has that genre.
+    [[nodiscard]] uint32_t getGenreSize(const string& name) const {
+        uint32_t genre;
+        return findGenre(name, genre) ? getGenreSize(genre) : 0;
+    }
+
+    //returns the catalog indices of every artist in a genre, in data set order, straight out of the genre index.
+    [[nodiscard]] IndexRange getGenreMembers(uint32_t genre) const {
+        const uint32_t* first = genreMembers + genres[genre].firstMember;
+        return {first, first + genres[genre].memberCount};
+    }
+
+    //returns the catalog indices of every artist in a genre from least to most familiar.
+    [[nodiscard]] IndexRange getGenreByFamiliarity(uint32_t genre) const {
+        const uint32_t* first = nicheIndex.data() + genres[genre].firstMember;
+        return {first, first + genres[genre].memberCount};
+    }
+
+    //returns the k least familiar artists in a genre whose familiarity is under the threshold, least familiar first...
+    //a binary search for the threshold and a slice of the niche index.
+    [[nodiscard]] IndexRange getNichest(uint32_t genre, float threshold, uint32_t k) const {
+        IndexRange sorted = getGenreByFamiliarity(genre);
+        const uint32_t* underThreshold = partition_point(sorted.begin(), sorted.end(), [this, threshold](uint32_t artist) {
+            return table.familiarity[artist] < threshold;
+        });
+        return {sorted.begin(), sorted.begin() + min<size_t>(k, static_cast<size_t>(underThreshold - sorted.begin()))};
+    }
+
+    //hash of the json file the catalog was loaded from...identifies the data set.
+    [[nodiscard]] uint64_t getDatasetHash() const {
+        return header != nullptr ? header->sourceHash : 0;
+    }
+
+    [[nodiscard]] bool isFromSnapshot() const {
+        return loadedFromSnapshot;
+    }
+
+    //time spent loading the data set in milliseconds.
+    [[nodiscard]] double getLoadTime() const {
+        return loadTime;
+    }
+
+    //heap allocations made by the last load...only counted when built with COUNT_ALLOCATIONS, see countingAllocations.
+    [[nodiscard]] size_t getLoadAllocations() const {
+        return loadAllocations;
+    }
+
+    //json parsing speed of the last load in MB/s...0 when the snapshot was mapped instead.
+    [[nodiscard]] double getThroughput() const {
+        if (parseTime <= 0.0 || parsedFileSize == 0) {
+            return 0.0;
+        }
+        return (static_cast<double>(parsedFileSize) / (1024.0 * 1024.0)) / (parseTime / 1000.0);
+    }
+
+    //number of bytes the catalog keeps in memory...a mapped snapshot is shared with other processes through the page cache.
+    [[nodiscard]] size_t getMemoryUsage() const {
+        return snapshotSize;
+    }
+};
+
+//Visited marks that can be reused across traversals...instead of clearing the array, each traversal
+//starts a new epoch and a node counts as visited only if its stamp matches the current epoch.
+class VisitedSet {
+private:
+    vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+
+public:
+    //forgets every visited node...only allocates when the graph has grown since the last traversal.
+    void reset(size_t nodeCount) {
+        if (stamps.size() < nodeCount) {
+            stamps.resize(nodeCount, 0);
+        }
+        epoch++;
+        //after 4 billion traversals the epoch wraps around, so old stamps have to be cleared once.
+        if (epoch == 0) {
+            fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    //marks a node as visited...returns false if it already was.
+    bool visit(uint32_t node) {
+        if (stamps[node] == epoch) {
+            return false;
+        }
+        stamps[node] = epoch;
+        return true;
+    }
+
+    [[nodiscard]] bool isVisited(uint32_t node) const {
+        return stamps[node] == epoch;
+    }
+};
+
+//Node waiting in a best-first search, ordered by score and then by node so ties always break the same way.
+struct ScoredNode {
+    float score;
+    uint32_t node;
+    uint32_t hops;
+
+    bool operator<(const ScoredNode& other) const {
+        return score < other.score || (score == other.score && node < other.node);
+    }
+
+    bool operator>(const ScoredNode& other) const {
+        return other < *this;
+    }
+};
+
+//Scratch space for traversals, kept per thread so back-to-back queries don't allocate or hash anything.
+struct TraversalContext {
+    VisitedSet visited;
+    //used as the BFS queue or the DFS stack, with each entry's hops from the start alongside.
+    vector<uint32_t> frontier;
+    vector<uint32_t> frontierDepths;
+    //one bit per node marking the current level, used by bottom-up BFS steps...left all zero between traversals.
+    vector<uint64_t> frontierBits;
+    //the search from the far end of a path query, its frontier, and the node each side reached every node from.
+    VisitedSet backwardVisited;
+    vector<uint32_t> backwardFrontier;
+    vector<uint32_t> nextFrontier;
+    vector<uint32_t> forwardParents;
+    vector<uint32_t> backwardParents;
+    //personalized PageRank's score and leftover probability for each node it has touched...a node's entries are only
+    //meaningful once it's marked in visited, and are zeroed when it is.
+    vector<float> pageRankScores;
+    vector<float> pageRankResiduals;
+    vector<uint8_t> pageRankQueued;
+    vector<uint32_t> pageRankTouched;
+    //visits to each niche node by this thread's random walkers, and the nodes with a count...all zero between queries.
+    vector<uint32_t> walkCounts;
+    vector<uint32_t> walkTouched;
+    //best-first search's frontier (a min-heap) and its k best results so far (a max-heap).
+    vector<ScoredNode> bestFirstQueue;
+    vector<ScoredNode> bestFirstResults;
+    //number of edges looked at by the last traversal on this thread.
+    size_t edgesExamined = 0;
+};
+
+TraversalContext& getTraversalContext() {
+    thread_local TraversalContext context;
+    return context;
+}
+
+//Fixed set of worker threads that run one parallel job at a time...the calling thread joins in as worker 0,
+//so a pool of one thread runs everything inline.
+class ThreadPool {
+private:
+    vector<thread> workers;
+    //held for the whole of run(), so jobs submitted from several threads at once take turns.
+    mutex runLock;
+    mutex jobLock;
+    condition_variable jobReady;
+    condition_variable jobDone;
+    const function<void(size_t)>* job = nullptr;
+    uint64_t generation = 0;
+    size_t running = 0;
+    bool stopping = false;
+
+    void workerLoop(size_t index) {
+        uint64_t finished = 0;
+        while (true) {
+            const function<void(size_t)>* current;
+            {
+                unique_lock<mutex> guard(jobLock);
+                jobReady.wait(guard, [&]() { return stopping || generation != finished; });
+                if (stopping) {
+                    return;
+                }
+                finished = generation;
+                current = job;
+            }
+            (*current)(index);
+            {
+                lock_guard<mutex> guard(jobLock);
+                if (--running == 0) {
+                    jobDone.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threadCount) {
+        for (size_t i = 1; i < max<size_t>(threadCount, 1); ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(jobLock);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    [[nodiscard]] size_t getThreadCount() const {
+        return workers.size() + 1;
+    }
+
+    //calls task(worker) once on every thread, worker going from 0 to getThreadCount() - 1, and waits for all of them.
+    //Calls from other threads wait for the current job to finish, but a task must not call run() on its own pool.
+    void run(const function<void(size_t)>& task) {
+        if (workers.empty()) {
+            task(0);
+            return;
+        }
+        lock_guard<mutex> turn(runLock);
+        {
+            lock_guard<mutex> guard(jobLock);
+            job = &task;
+            running = workers.size();
+            generation++;
+        }
+        jobReady.notify_all();
+        task(0);
+        unique_lock<mutex> guard(jobLock);
+        jobDone.wait(guard, [this]() { return running == 0; });
+    }
+
+    //splits [0, count) into chunks handed out through a shared counter and calls body(begin, end, worker) for each one.
+    template <typename Body>
+    void parallelFor(size_t count, size_t chunk, Body body) {
+        atomic<size_t> next{0};
+        run([&](size_t worker) {
+            for (size_t begin = next.fetch_add(chunk, memory_order_relaxed); begin < count; begin = next.fetch_add(chunk, memory_order_relaxed)) {
+                body(begin, min(begin + chunk, count), worker);
+            }
+        });
+    }
+};
+
+//Pool with one thread per core shared by every query that needs one, created on first use.
+ThreadPool& getSharedPool() {
+    static ThreadPool pool(max(1u, thread::hardware_concurrency()));
+    return pool;
+}
+
+//Small, fast pseudo-random number generator (SplitMix64)...every random walker makes its own, so drawing numbers never
+//needs a lock, and the same seed and stream always give the same numbers.
+class FastRandom {
+private:
+    uint64_t state;
+
+public:
+    FastRandom(uint64_t seed, uint64_t stream) : state(seed) {
+        state = next() ^ stream;
+        state = next();
+    }
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    //uniform number from 0 to bound - 1, by scaling the top 32 bits instead of dividing.
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+};
+
+//One bit per node that several threads can claim at once...claim() returns true for exactly one caller per node.
+class AtomicBitmap {
+private:
+    vector<atomic<uint64_t>> words;
+
+public:
+    explicit AtomicBitmap(size_t size) : words((size + 63) / 64) {
+        for (auto& word : words) {
+            word.store(0, memory_order_relaxed);
+        }
+    }
+
+    //checks the bit before the fetch_or so nodes that are already claimed don't bounce the cache line around.
+    bool claim(uint32_t node) {
+        uint64_t bit = 1ULL << (node & 63);
+        atomic<uint64_t>& word = words[node >> 6];
+        return (word.load(memory_order_relaxed) & bit) == 0 && (word.fetch_or(bit, memory_order_relaxed) & bit) == 0;
+    }
+};
+
+//Per-worker counts from a work-stealing parallel DFS.
+struct DfsWorkerStats {
+    size_t visited = 0;
+    size_t steals = 0;
+    //times the worker found every deque empty while other workers were still busy.
+    size_t failedSteals = 0;
+};
+
+//Nodes reached by a work-stealing parallel DFS, each exactly once and grouped by the worker that visited it.
+struct ParallelDfsResult {
+    vector<uint32_t> nodes;
+    vector<DfsWorkerStats> workers;
+};
+
+//Nodes reached by a level-by-level BFS...level l is nodes[levelOffsets[l]] to nodes[levelOffsets[l + 1] - 1].
+struct BfsLevels {
+    vector<uint32_t> nodes;
+    vector<size_t> levelOffsets = {0};
+
+    [[nodiscard]] size_t getLevelCount() const {
+        return levelOffsets.size() - 1;
+    }
+
+    [[nodiscard]] IndexRange getLevel(size_t level) const {
+        return {nodes.data() + levelOffsets[level], nodes.data() + levelOffsets[level + 1]};
+    }
+};
+
+//Direction a level-by-level BFS expands in...top-down scans the frontier's edges for unvisited nodes, bottom-up scans
+//the unvisited nodes' edges for one in the frontier, and Auto switches between them as the frontier grows and shrinks.
+enum class BfsDirection { Auto, TopDown, BottomUp };
+
+//Artists below this familiarity count as niche, and each traversal recommends at most this many of them.
+const float defaultNicheThreshold = 0.5f;
+const uint32_t defaultRecommendationCount = 5;
+//Most recommendations the results window lets a traversal ask for.
+const uint32_t maxRecommendationCount = 50;
+
+//What a recommendation traversal is asked for...up to k artists under the familiarity threshold, starting from node
+//start and looking no further than maxDepth hops from it.
+struct RecommendationQuery {
+    uint32_t start = 0;
+    float threshold = defaultNicheThreshold;
+    uint32_t k = defaultRecommendationCount;
+    uint32_t maxDepth = UINT32_MAX;
+
+    bool operator==(const RecommendationQuery& other) const {
+        return start == other.start && threshold == other.threshold && k == other.k && maxDepth == other.maxDepth;
+    }
+};
+
+//Orders a recommendation query can walk the graph in, each run by the Graph method named beside it.
+enum class TraversalOrder {
+    BreadthFirst, //BFS
+    DepthFirst,   //DFS
+    BestFirst,    //bestFirst
+    PageRank,     //personalizedPageRank
+    RandomWalk    //randomWalks
+};
+
+//Every traversal order, in the order the results window offers them.
+const vector<TraversalOrder> allTraversalOrders = {TraversalOrder::BreadthFirst, TraversalOrder::DepthFirst, TraversalOrder::BestFirst,
+                                                   TraversalOrder::PageRank, TraversalOrder::RandomWalk};
+
+//Chance a personalized PageRank walk jumps back to the start at each step, and the residual per edge below which a
+//node's score isn't pushed on to its neighbors...smaller epsilons are more accurate but touch more of the graph.
+const float defaultRestartProbability = 0.15f;
+const float defaultPageRankEpsilon = 1e-5f;
+
+//How many random walks a Monte Carlo recommendation takes from the start, how many steps each one is, and the seed
+//they're drawn from...the same settings always give the same recommendations.
+struct RandomWalkSettings {
+    uint32_t walkCount = 10000;
+    uint32_t walkLength = 8;
+    uint64_t seed = 42;
+};
+
+//What a traversal visitor sees of each node...the strings point into the graph and stay valid until it changes.
+struct NodeView {
+    uint32_t index;
+    string_view id;
+    string_view name;
+    float familiarity;
+    //hops from the start along the path the traversal reached the node by.
+    uint32_t depth;
+};
+
+//Niche artist found from a set of seed artists, with how many hops it is from the nearest one.
+struct SeededRecommendation {
+    string_view name;
+    uint32_t hops;
+};
+
+//Shortest chain of similar artists between two artists, and how much work the search for it took.
+struct ArtistPath {
+    //nodes from the first artist to the last...empty if they aren't connected.
+    vector<uint32_t> nodes;
+    size_t nodesExpanded = 0;
+    size_t edgesExamined = 0;
+};
+
 //Class for creating artist graph.
+//Artist IDs are interned to dense node indices when artists are added, so traversals only ever touch integers.
 class Graph {
 private:
-    //map for storing artists and their IDs...graph in the form of an adjacency list.
-    unordered_map<string, json> artists;
-    unordered_map<string, vector<string>> adjacencyList;
+    //artist columns...node i is row i of the table, so traversals read familiarity and names straight from the catalog.
+    ArtistTable table;
+    //lowest familiarity of any artist and of each genre's artists, the best score a best-first search could still find
+    //down an unexplored branch...the genre's is used while no edge joins artists of different genres.
+    float minFamiliarity = 0.0f;
+    vector<float> genreMinFamiliarity;
+    bool edgesCrossGenres = false;
+
+    //string pool handle of an artist ID -> node...only used when edges are added by ID and when a traversal starts.
+    static constexpr uint32_t noNode = UINT32_MAX;
+    vector<uint32_t> nodeOf;
+
+    //edges waiting to be added by build().
+    vector<pair<uint32_t, uint32_t>> pendingEdges;
+
+    //compressed sparse row adjacency...node i's neighbors are neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1].
+    vector<uint64_t> offsets = {0};
+    vector<uint32_t> neighbors;
+    size_t edgeCount = 0;
+
+    //implicit cliques...every node in a clique is connected to every other member without storing those edges.
+    //Clique c's members are cliqueMembers[cliqueOffsets[c]] to cliqueMembers[cliqueOffsets[c + 1] - 1].
+    static constexpr uint32_t noClique = UINT32_MAX;
+    vector<uint32_t> cliqueOf;
+    vector<uint64_t> cliqueOffsets = {0};
+    vector<uint32_t> cliqueMembers;
+    size_t cliqueEdgeCount = 0;
+
+public:
+    Graph() = default;
+
+    //creates a graph with one node per artist in the table and no edges...the table must outlive the graph.
+    //Artist IDs are interned so starting a traversal by ID is one pool lookup.
+    explicit Graph(const ArtistTable& artists) : table(artists), cliqueOf(artists.count, noClique) {
+        StringPool& pool = getStringPool();
+        nodeOf.assign(pool.getCount() + table.count, noNode);
+        for (uint32_t i = 0; i < table.count; ++i) {
+            nodeOf[pool.intern(table.getId(i))] = i;
+        }
+        nodeOf.resize(pool.getCount());
+
+        if (table.count > 0) {
+            minFamiliarity = *min_element(table.familiarity, table.familiarity + table.count);
+            genreMinFamiliarity.assign(*max_element(table.genre, table.genre + table.count) + 1, numeric_limits<float>::infinity());
+            for (uint32_t i = 0; i < table.count; ++i) {
+                genreMinFamiliarity[table.genre[i]] = min(genreMinFamiliarity[table.genre[i]], table.familiarity[i]);
+            }
+        }
+    }
+
+    //looks up the node for an artist ID...returns false if the artist isn't in the graph.
+    bool findIndex(string_view id, uint32_t& index) const {
+        uint32_t handle;
+        if (!getStringPool().find(id, handle) || handle >= nodeOf.size() || nodeOf[handle] == noNode) {
+            return false;
+        }
+        index = nodeOf[handle];
+        return true;
+    }
+
+    //creates an edge between artists.
+    void addEdge(string_view id1, string_view id2) {
+        uint32_t index1, index2;
+        if (findIndex(id1, index1) && findIndex(id2, index2)) {
+            addEdge(index1, index2);
+        }
+    }
+
+    //creates an edge between two node indices...it's stored once build() runs.
+    void addEdge(uint32_t index1, uint32_t index2) {
+        pendingEdges.emplace_back(index1, index2);
+        edgeCount++;
+        edgesCrossGenres = edgesCrossGenres || table.genre[index1] != table.genre[index2];
+    }
+
+    //connects every pair of the given nodes through one implicit clique, which takes O(n) memory instead of O(n^2) edges.
+    //Meant for equivalence relations like "same genre", so each node belongs to at most one clique and
+    //any other relationships still go through addEdge.
+    void addClique(const vector<uint32_t>& members) {
+        auto clique = static_cast<uint32_t>(cliqueOffsets.size() - 1);
+        for (uint32_t node : members) {
+            if (cliqueOf[node] == noClique) {
+                cliqueOf[node] = clique;
+                cliqueMembers.push_back(node);
+                edgesCrossGenres = edgesCrossGenres || table.genre[node] != table.genre[cliqueMembers[cliqueOffsets[clique]]];
+            }
+        }
+        cliqueOffsets.push_back(cliqueMembers.size());
+
+        size_t size = cliqueOffsets[clique + 1] - cliqueOffsets[clique];
+        cliqueEdgeCount += size * (size - (size > 0 ? 1 : 0)) / 2;
+    }
+
+    //calls visit for every neighbor of a node...the other members of its clique first, then its explicit edges.
+    //Returns the number of edges looked at.
+    template <typename Visit>
+    size_t forEachNeighbor(uint32_t node, Visit visit) const {
+        size_t examined = 0;
+        uint32_t clique = cliqueOf[node];
+        if (clique != noClique) {
+            examined += cliqueOffsets[clique + 1] - cliqueOffsets[clique] - 1;
+            for (uint64_t i = cliqueOffsets[clique]; i < cliqueOffsets[clique + 1]; ++i) {
+                if (cliqueMembers[i] != node) {
+                    visit(cliqueMembers[i]);
+                }
+            }
+        }
+
+        examined += offsets[node + 1] - offsets[node];
+        for (uint64_t i = offsets[node]; i < offsets[node + 1]; ++i) {
+            visit(neighbors[i]);
+        }
+        return examined;
+    }
+
+    //calls visit for the same neighbors in the same order as forEachNeighbor, stopping as soon as it returns true.
+    //Returns the number of edges looked at.
+    template <typename Visit>
+    size_t findNeighbor(uint32_t node, Visit visit) const {
+        size_t examined = 0;
+        uint32_t clique = cliqueOf[node];
+        if (clique != noClique) {
+            for (uint64_t i = cliqueOffsets[clique]; i < cliqueOffsets[clique + 1]; ++i) {
+                if (cliqueMembers[i] != node) {
+                    examined++;
+                    if (visit(cliqueMembers[i])) {
+                        return examined;
+                    }
+                }
+            }
+        }
+
+        for (uint64_t i = offsets[node]; i < offsets[node + 1]; ++i) {
+            examined++;
+            if (visit(neighbors[i])) {
+                return examined;
+            }
+        }
+        return examined;
+    }
+
+    //number of neighbors a node has, counting the other members of its clique...only valid once the graph is built.
+    [[nodiscard]] size_t getDegree(uint32_t node) const {
+        size_t degree = offsets[node + 1] - offsets[node];
+        uint32_t clique = cliqueOf[node];
+        if (clique != noClique) {
+            degree += cliqueOffsets[clique + 1] - cliqueOffsets[clique] - 1;
+        }
+        return degree;
+    }
+
+    //the i-th neighbor of a node, for i below getDegree(node)...its own edges come first, then the rest of its clique.
+    //The graph must be built.
+    [[nodiscard]] uint32_t getNeighbor(uint32_t node, size_t i) const {
+        size_t edges = offsets[node + 1] - offsets[node];
+        if (i < edges) {
+            return neighbors[offsets[node] + i];
+        }
+        i -= edges;
+        uint32_t clique = cliqueOf[node];
+        const uint32_t* members = cliqueMembers.data() + cliqueOffsets[clique];
+        size_t last = cliqueOffsets[clique + 1] - cliqueOffsets[clique] - 1;
+        //the clique's last member stands in for the node itself, so each of the others is picked equally often.
+        return members[i] == node ? members[last] : members[i];
+    }
+
+    //packs the pending edges into the CSR arrays, keeping each node's neighbors in the order their edges were added.
+    //Traversals call this themselves, so it only needs calling directly to control when the work happens.
+    void build() {
+        size_t nodeCount = table.count;
+        if (pendingEdges.empty() && offsets.size() == nodeCount + 1) {
+            return;
+        }
+
+        //counts every node's degree, then turns the counts into offsets.
+        vector<uint64_t> newOffsets(nodeCount + 1, 0);
+        for (size_t node = 0; node + 1 < offsets.size(); ++node) {
+            newOffsets[node + 1] = offsets[node + 1] - offsets[node];
+        }
+        for (const auto& edge : pendingEdges) {
+            newOffsets[edge.first + 1]++;
+            newOffsets[edge.second + 1]++;
+        }
+        for (size_t node = 0; node < nodeCount; ++node) {
+            newOffsets[node + 1] += newOffsets[node];
+        }
+
+        vector<uint32_t> newNeighbors(newOffsets[nodeCount]);
+        vector<uint64_t> next(newOffsets.begin(), newOffsets.end() - 1);
+        for (size_t node = 0; node + 1 < offsets.size(); ++node) {
+            for (uint64_t i = offsets[node]; i < offsets[node + 1]; ++i) {
+                newNeighbors[next[node]++] = neighbors[i];
+            }
+        }
+        for (const auto& edge : pendingEdges) {
+            newNeighbors[next[edge.first]++] = edge.second;
+            newNeighbors[next[edge.second]++] = edge.first;
+        }
+
+        offsets.swap(newOffsets);
+        neighbors.swap(newNeighbors);
+        pendingEdges.clear();
+        pendingEdges.shrink_to_fit();
+    }
+
+    //walks the graph from one or more start nodes in breadth-first or depth-first order, handing each node to the visitor
+    //as a view into the graph without copying anything...the visitor returns false to stop the traversal early. Nodes
+    //maxDepth hops from their start are visited but not expanded. Every start node is at depth 0, so a breadth-first
+    //walk reaches each node at its distance from the nearest one.
+    template <TraversalOrder Order, typename Visitor>
+    void traverse(IndexRange starts, Visitor&& visitor, uint32_t maxDepth = UINT32_MAX) {
+        static_assert(Order != TraversalOrder::BestFirst, "best-first search is Graph::bestFirst");
+        build();
+        TraversalContext& context = getTraversalContext();
+        VisitedSet& visited = context.visited;
+        vector<uint32_t>& frontier = context.frontier;
+        vector<uint32_t>& depths = context.frontierDepths;
+        size_t head = 0;
+        context.edgesExamined = 0;
+
+        visited.reset(table.count);
+        frontier.clear();
+        depths.clear();
+        for (uint32_t start : starts) {
+            if (visited.visit(start)) {
+                frontier.push_back(start);
+                depths.push_back(0);
+            }
+        }
+
+        //the frontier is a queue read from the front for BFS and a stack popped from the back for DFS.
+        while (head < frontier.size()) {
+            uint32_t current;
+            uint32_t depth;
+            if constexpr (Order == TraversalOrder::BreadthFirst) {
+                current = frontier[head];
+                depth = depths[head++];
+            } else {
+                current = frontier.back();
+                depth = depths.back();
+                frontier.pop_back();
+                depths.pop_back();
+            }
+
+            if (!visitor(NodeView{current, table.getId(current), table.getName(current), table.familiarity[current], depth})) {
+                return;
+            }
+            if (depth == maxDepth) {
+                continue;
+            }
+
+            context.edgesExamined += forEachNeighbor(current, [&](uint32_t neighbor) {
+                if (visited.visit(neighbor)) {
+                    frontier.push_back(neighbor);
+                    depths.push_back(depth + 1);
+                }
+            });
+        }
+    }
+
+    //same as above, starting from a single node.
+    template <TraversalOrder Order, typename Visitor>
+    void traverse(uint32_t start, Visitor&& visitor, uint32_t maxDepth = UINT32_MAX) {
+        traverse<Order>(IndexRange{&start, &start + 1}, forward<Visitor>(visitor), maxDepth);
+    }
+
+    //same as above, starting from an artist ID...does nothing if the artist isn't in the graph.
+    template <TraversalOrder Order, typename Visitor>
+    void traverse(string_view startId, Visitor&& visitor, uint32_t maxDepth = UINT32_MAX) {
+        uint32_t start;
+        if (findIndex(startId, start)) {
+            traverse<Order>(start, forward<Visitor>(visitor), maxDepth);
+        }
+    }
+
+    //main breadth-first traversal function...takes in the starting node and returns recommended artists.
+    //The names are views into the artist table, so they stay valid as long as the catalog does.
+    //Stops early with whatever it has found if cancelled is set from another thread.
+    vector<string_view> BFS(const RecommendationQuery& query, const atomic<bool>* cancelled = nullptr) {
+        vector<string_view> bfsResults;
+        if (query.k == 0 || query.start >= table.count) {
+            return bfsResults;
+        }
+        bfsResults.reserve(query.k);
+
+        //Only gives at most k recommended artists...makes sure to only give niche artists with familiarity below the threshold.
+        traverse<TraversalOrder::BreadthFirst>(query.start, [&](const NodeView& artist) {
+            if (cancelled != nullptr && cancelled->load(memory_order_relaxed)) {
+                return false;
+            }
+            if (artist.familiarity < query.threshold) {
+                bfsResults.emplace_back(artist.name);
+            }
+            return bfsResults.size() < query.k;
+        }, query.maxDepth);
+        return bfsResults;
+    }
+
+    //main depth-first traversal function with same input and output as BFS...the depth limit counts hops along the
+    //path the search took, which can be longer than the shortest one.
+    vector<string_view> DFS(const RecommendationQuery& query, const atomic<bool>* cancelled = nullptr) {
+        vector<string_view> dfsResults;
+        if (query.k == 0 || query.start >= table.count) {
+            return dfsResults;
+        }
+        dfsResults.reserve(query.k);
+
+        traverse<TraversalOrder::DepthFirst>(query.start, [&](const NodeView& artist) {
+            if (cancelled != nullptr && cancelled->load(memory_order_relaxed)) {
+                return false;
+            }
+            if (artist.familiarity < query.threshold) {
+                dfsResults.emplace_back(artist.name);
+            }
+            return dfsResults.size() < query.k;
+        }, query.maxDepth);
+        return dfsResults;
+    }
+
+    //breadth-first search from every seed at once, such as a user's liked artists...returns up to k niche artists ranked
+    //by hops from the nearest seed, leaving the seeds themselves out. query.start is ignored and seeds that aren't nodes
+    //are skipped. It's one pass over the graph however many seeds there are.
+    vector<SeededRecommendation> multiSourceBFS(const vector<uint32_t>& seeds, const RecommendationQuery& query, const atomic<bool>* cancelled = nullptr) {
+        vector<SeededRecommendation> results;
+        vector<uint32_t> starts;
+        starts.reserve(seeds.size());
+        for (uint32_t seed : seeds) {
+            if (seed < table.count) {
+                starts.push_back(seed);
+            }
+        }
+        if (query.k == 0 || starts.empty()) {
+            return results;
+        }
+        results.reserve(query.k);
+
+        traverse<TraversalOrder::BreadthFirst>(IndexRange{starts.data(), starts.data() + starts.size()}, [&](const NodeView& artist) {
+            if (cancelled != nullptr && cancelled->load(memory_order_relaxed)) {
+                return false;
+            }
+            if (artist.depth > 0 && artist.familiarity < query.threshold) {
+                results.push_back({artist.name, artist.depth});
+            }
+            return results.size() < query.k;
+        }, query.maxDepth);
+        return results;
+    }
+
+    //shortest chain of artists from one node to another, found by a breadth-first search from each end that always
+    //expands a whole level of whichever side's frontier is smaller...the two searches meet in the middle, so they expand
+    //far fewer nodes than a search from one end would. Ends at the first edge joining the two sides, which lies on a
+    //shortest path since each side finishes a level before the other goes on.
+    ArtistPath findPath(uint32_t from, uint32_t to) {
+        ArtistPath path;
+        if (from >= table.count || to >= table.count) {
+            return path;
+        }
+        if (from == to) {
+            path.nodes.push_back(from);
+            return path;
+        }
+
+        build();
+        TraversalContext& context = getTraversalContext();
+        VisitedSet* visited[2] = {&context.visited, &context.backwardVisited};
+        vector<uint32_t>* frontier[2] = {&context.frontier, &context.backwardFrontier};
+        vector<uint32_t>* parents[2] = {&context.forwardParents, &context.backwardParents};
+        vector<uint32_t>& next = context.nextFrontier;
+        for (int side = 0; side < 2; ++side) {
+            visited[side]->reset(table.count);
+            frontier[side]->clear();
+            parents[side]->resize(table.count);
+        }
+        frontier[0]->push_back(from);
+        visited[0]->visit(from);
+        frontier[1]->push_back(to);
+        visited[1]->visit(to);
+
+        //the edge where the searches met, with its end on the forward side first.
+        uint32_t meetForward = noNode;
+        uint32_t meetBackward = noNode;
+        while (meetForward == noNode && !frontier[0]->empty() && !frontier[1]->empty()) {
+            int side = frontier[0]->size() <= frontier[1]->size() ? 0 : 1;
+            int other = 1 - side;
+            next.clear();
+            for (uint32_t node : *frontier[side]) {
+                path.nodesExpanded++;
+                path.edgesExamined += findNeighbor(node, [&](uint32_t neighbor) {
+                    if (visited[other]->isVisited(neighbor)) {
+                        meetForward = side == 0 ? node : neighbor;
+                        meetBackward = side == 0 ? neighbor : node;
+                        return true;
+                    }
+                    if (visited[side]->visit(neighbor)) {
+                        (*parents[side])[neighbor] = node;
+                        next.push_back(neighbor);
+                    }
+                    return false;
+                });
+                if (meetForward != noNode) {
+                    break;
+                }
+            }
+            swap(*frontier[side], next);
+        }
+        context.edgesExamined = path.edgesExamined;
+        if (meetForward == noNode) {
+            return path;
+        }
+
+        for (uint32_t node = meetForward; node != from; node = context.forwardParents[node]) {
+            path.nodes.push_back(node);
+        }
+        path.nodes.push_back(from);
+        reverse(path.nodes.begin(), path.nodes.end());
+        for (uint32_t node = meetBackward; node != to; node = context.backwardParents[node]) {
+            path.nodes.push_back(node);
+        }
+        path.nodes.push_back(to);
+        return path;
+    }
+
+    //personalized PageRank (random walk with restart) from the start node, approximated by pushing probability out from
+    //the start: a node holding residual r keeps restart * r as score and spreads the rest evenly over its neighbors,
+    //until no node holds epsilon or more per edge. Each score is then within epsilon times the node's degree of the
+    //exact value, and only O(1 / (restart * epsilon)) pushes are made however big the graph is. Returns the k niche
+    //artists with the highest scores, highest first and ties broken by node, leaving out the start artist itself.
+    //query.maxDepth is ignored. getEdgesExamined() gives the edges the pushes went along.
+    vector<string_view> personalizedPageRank(const RecommendationQuery& query, const atomic<bool>* cancelled = nullptr,
+                                             float epsilon = defaultPageRankEpsilon, float restart = defaultRestartProbability) {
+        vector<string_view> ranked;
+        if (query.k == 0 || query.start >= table.count || epsilon <= 0.0f) {
+            return ranked;
+        }
+
+        build();
+        TraversalContext& context = getTraversalContext();
+        VisitedSet& touched = context.visited;
+        vector<float>& scores = context.pageRankScores;
+        vector<float>& residuals = context.pageRankResiduals;
+        vector<uint8_t>& queued = context.pageRankQueued;
+        vector<uint32_t>& touchedNodes = context.pageRankTouched;
+        vector<uint32_t>& queue = context.frontier;
+        touched.reset(table.count);
+        scores.resize(table.count);
+        residuals.resize(table.count);
+        queued.resize(table.count);
+        touchedNodes.clear();
+        queue.clear();
+        context.edgesExamined = 0;
+
+        auto touch = [&](uint32_t node) {
+            if (touched.visit(node)) {
+                scores[node] = 0.0f;
+                residuals[node] = 0.0f;
+                queued[node] = 0;
+                touchedNodes.push_back(node);
+            }
+        };
+
+        touch(query.start);
+        residuals[query.start] = 1.0f;
+        queue.push_back(query.start);
+        queued[query.start] = 1;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            if (cancelled != nullptr && cancelled->load(memory_order_relaxed)) {
+                break;
+            }
+            uint32_t node = queue[head];
+            queued[node] = 0;
+            float residual = residuals[node];
+            residuals[node] = 0.0f;
+            size_t degree = getDegree(node);
+            //a walk can't leave an artist with no edges, so it stays there.
+            if (degree == 0) {
+                scores[node] += residual;
+                continue;
+            }
+
+            scores[node] += restart * residual;
+            float share = (1.0f - restart) * residual / static_cast<float>(degree);
+            context.edgesExamined += forEachNeighbor(node, [&](uint32_t neighbor) {
+                touch(neighbor);
+                residuals[neighbor] += share;
+                if (!queued[neighbor] && residuals[neighbor] >= epsilon * static_cast<float>(getDegree(neighbor))) {
+                    queued[neighbor] = 1;
+                    queue.push_back(neighbor);
+                }
+            });
+        }
+
+        //niche artists by score, highest first...stored negated so ScoredNode's ordering puts them first.
+        vector<ScoredNode>& candidates = context.bestFirstResults;
+        candidates.clear();
+        for (uint32_t node : touchedNodes) {
+            if (node != query.start && scores[node] > 0.0f && table.familiarity[node] < query.threshold) {
+                candidates.push_back({-scores[node], node, 0});
+            }
+        }
+        size_t count = min<size_t>(query.k, candidates.size());
+        partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        ranked.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            ranked.push_back(table.getName(candidates[i].node));
+        }
+        return ranked;
+    }
+
+    //Monte Carlo recommendation...takes walkCount random walks of walkLength steps from the start, each step moving to
+    //a neighbor picked uniformly, and ranks niche artists by how often the walks stepped on them, most first and ties
+    //broken by node. The start artist is left out, and a walk ends early at an artist with no edges. Walks are split
+    //into batches spread over the pool's threads, and each batch draws from its own generator seeded from the seed and
+    //the batch number, so the result depends only on the settings and not on the thread count or timing.
+    //query.maxDepth is ignored.
+    vector<string_view> randomWalks(const RecommendationQuery& query, ThreadPool& pool, const RandomWalkSettings& settings = {},
+                                    const atomic<bool>* cancelled = nullptr) {
+        const uint32_t walksPerBatch = 256;
+        vector<string_view> ranked;
+        if (query.k == 0 || query.start >= table.count || settings.walkCount == 0) {
+            return ranked;
+        }
+
+        build();
+        size_t batchCount = (settings.walkCount + walksPerBatch - 1) / walksPerBatch;
+        atomic<size_t> nextBatch{0};
+        //each worker's (node, visits) pairs, handed back once it runs out of batches.
+        vector<vector<pair<uint32_t, uint32_t>>> workerVisits(pool.getThreadCount());
+        pool.run([&](size_t worker) {
+            TraversalContext& context = getTraversalContext();
+            vector<uint32_t>& counts = context.walkCounts;
+            vector<uint32_t>& touched = context.walkTouched;
+            counts.resize(table.count, 0);
+            touched.clear();
+
+            for (size_t batch = nextBatch.fetch_add(1); batch < batchCount; batch = nextBatch.fetch_add(1)) {
+                if (cancelled != nullptr && cancelled->load(memory_order_relaxed)) {
+                    break;
+                }
+                FastRandom random(settings.seed, batch);
+                uint32_t walks = min<uint32_t>(walksPerBatch, settings.walkCount - static_cast<uint32_t>(batch) * walksPerBatch);
+                for (uint32_t walk = 0; walk < walks; ++walk) {
+                    uint32_t node = query.start;
+                    for (uint32_t step = 0; step < settings.walkLength; ++step) {
+                        auto degree = static_cast<uint32_t>(getDegree(node));
+                        if (degree == 0) {
+                            break;
+                        }
+                        node = getNeighbor(node, random.below(degree));
+                        if (node != query.start && table.familiarity[node] < query.threshold && counts[node]++ == 0) {
+                            touched.push_back(node);
+                        }
+                    }
+                }
+            }
+
+            for (uint32_t node : touched) {
+                workerVisits[worker].emplace_back(node, counts[node]);
+                counts[node] = 0;
+            }
+            touched.clear();
+        });
+
+        //adds up the workers' counts in this thread's context, ranks them, and leaves the counts at zero again.
+        TraversalContext& context = getTraversalContext();
+        vector<uint32_t>& counts = context.walkCounts;
+        vector<uint32_t>& touched = context.walkTouched;
+        counts.resize(table.count, 0);
+        for (const auto& visits : workerVisits) {
+            for (const auto& visit : visits) {
+                if (counts[visit.first] == 0) {
+                    touched.push_back(visit.first);
+                }
+                counts[visit.first] += visit.second;
+            }
+        }
+        vector<ScoredNode>& candidates = context.bestFirstResults;
+        candidates.clear();
+        for (uint32_t node : touched) {
+            candidates.push_back({-static_cast<float>(counts[node]), node, 0});
+            counts[node] = 0;
+        }
+        touched.clear();
+
+        size_t count = min<size_t>(query.k, candidates.size());
+        partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        ranked.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            ranked.push_back(table.getName(candidates[i].node));
+        }
+        return ranked;
+    }
+
+    //k least familiar reachable artists under the threshold, nichest first with ties broken by node...hopPenalty adds to a
+    //score per hop so closer artists win, and the search stops once its worst result is no worse than stopKey.
+    vector<string_view> bestFirst(const RecommendationQuery& query, const atomic<bool>* cancelled = nullptr, float hopPenalty = 0.0f,
+                                  ScoredNode stopKey = {-numeric_limits<float>::infinity(), 0, 0}) {
+        vector<string_view> bestResults;
+        const uint32_t start = query.start;
+        const uint32_t k = query.k;
+        if (k == 0 || start >= table.count) {
+            return bestResults;
+        }
+
+        build();
+        TraversalContext& context = getTraversalContext();
+        VisitedSet& visited = context.visited;
+        vector<ScoredNode>& queue = context.bestFirstQueue;
+        vector<ScoredNode>& results = context.bestFirstResults;
+        visited.reset(table.count);
+        queue.clear();
+        results.clear();
+        context.edgesExamined = 0;
+
+        //true if the artist would get into the results, beating the worst one held once there are k.
+        auto improves = [&](const ScoredNode& candidate) {
+            return results.size() < k || candidate < results.front();
+        };
+        //true once k results are held and nothing scoring at least bound can get into them...an artist scoring exactly
+        //the worst result's score could still beat it on node.
+        auto cannotImprove = [&](float bound) {
+            return results.size() == k && bound > results.front().score;
+        };
+        //true once k results are held and the worst of them is no worse than key.
+        auto reached = [&](const ScoredNode& key) {
+            return results.size() == k && !(key < results.front());
+        };
+        //lowest score anything hops away from the start could have.
+        const float lowestFamiliarity = edgesCrossGenres ? minFamiliarity : genreMinFamiliarity[table.genre[start]];
+        auto branchBound = [&](uint32_t hops) {
+            return lowestFamiliarity + hopPenalty * static_cast<float>(hops);
+        };
+
+        queue.push_back({table.familiarity[start], start, 0});
+        visited.visit(start);
+        while (!queue.empty() && !reached(stopKey)) {
+            if (cancelled != nullptr && cancelled->load(memory_order_relaxed)) {
+                break;
+            }
+            pop_heap(queue.begin(), queue.end(), greater<ScoredNode>());
+            ScoredNode current = queue.back();
+            queue.pop_back();
+
+            if (table.familiarity[current.node] < query.threshold && improves(current)) {
+                results.push_back(current);
+                push_heap(results.begin(), results.end());
+                if (results.size() > k) {
+                    pop_heap(results.begin(), results.end());
+                    results.pop_back();
+                }
+            }
+            if (current.hops == query.maxDepth || cannotImprove(branchBound(current.hops + 1))) {
+                continue;
+            }
+
+            context.edgesExamined += forEachNeighbor(current.node, [&](uint32_t neighbor) {
+                ScoredNode next{table.familiarity[neighbor] + hopPenalty * static_cast<float>(current.hops + 1), neighbor, current.hops + 1};
+                if (!visited.isVisited(neighbor) && (improves(next) || !cannotImprove(branchBound(next.hops + 1)))) {
+                    visited.visit(neighbor);
+                    queue.push_back(next);
+                    push_heap(queue.begin(), queue.end(), greater<ScoredNode>());
+                }
+            });
+        }
+
+        sort_heap(results.begin(), results.end());
+        bestResults.reserve(results.size());
+        for (const ScoredNode& result : results) {
+            bestResults.push_back(table.getName(result.node));
+        }
+        return bestResults;
+    }
+
+    //breadth-first search from one or more start nodes with no result cap, one whole level at a time...returns every
+    //reachable node grouped by its distance from the nearest start node.
+    BfsLevels levelBFS(const vector<uint32_t>& sources) {
+        build();
+        TraversalContext& context = getTraversalContext();
+        VisitedSet& visited = context.visited;
+        visited.reset(table.count);
+
+        BfsLevels levels;
+        for (uint32_t source : sources) {
+            if (visited.visit(source)) {
+                levels.nodes.push_back(source);
+            }
+        }
+        size_t levelBegin = 0;
+        while (levelBegin < levels.nodes.size()) {
+            size_t levelEnd = levels.nodes.size();
+            levels.levelOffsets.push_back(levelEnd);
+            for (size_t i = levelBegin; i < levelEnd; ++i) {
+                forEachNeighbor(levels.nodes[i], [&](uint32_t neighbor) {
+                    if (visited.visit(neighbor)) {
+                        levels.nodes.push_back(neighbor);
+                    }
+                });
+            }
+            levelBegin = levelEnd;
+        }
+        return levels;
+    }
+
+    //levelBFS that can expand a level bottom-up...once the frontier has at least as many nodes as are left unvisited
+    //with edges, and more than 1/bottomUpRatio as many edges as they have, every unvisited node checks its own edges and
+    //stops at the first one leading into the frontier (kept as a bitmap), which skips most of the edges a large
+    //frontier would look at. It goes back to top-down when the frontier drops under 1/topDownRatio of the nodes. The
+    //direction can be forced instead, and the levels match levelBFS either way. getEdgesExamined() gives the edges
+    //looked at.
+    BfsLevels directionOptimizingBFS(const vector<uint32_t>& sources, BfsDirection direction = BfsDirection::Auto) {
+        const size_t bottomUpRatio = 14;
+        const size_t topDownRatio = 24;
+
+        build();
+        TraversalContext& context = getTraversalContext();
+        VisitedSet& visited = context.visited;
+        vector<uint64_t>& frontierBits = context.frontierBits;
+        visited.reset(table.count);
+        frontierBits.resize((table.count + 63) / 64, 0);
+        context.edgesExamined = 0;
+
+        //edges still to be explored from unvisited nodes, counting each edge from both ends, and the unvisited nodes
+        //that have any.
+        size_t unexploredEdges = 2 * getEdgeCount();
+        size_t unexploredNodes = 0;
+        for (uint32_t node = 0; node < table.count; ++node) {
+            unexploredNodes += getDegree(node) > 0;
+        }
+
+        BfsLevels levels;
+        for (uint32_t source : sources) {
+            if (visited.visit(source)) {
+                levels.nodes.push_back(source);
+                unexploredEdges -= getDegree(source);
+                unexploredNodes -= getDegree(source) > 0;
+            }
+        }
+        bool bottomUp = direction == BfsDirection::BottomUp;
+        size_t levelBegin = 0;
+        size_t previousLevelSize = 0;
+        while (levelBegin < levels.nodes.size()) {
+            size_t levelEnd = levels.nodes.size();
+            levels.levelOffsets.push_back(levelEnd);
+
+            //only switches to bottom-up while the frontier is still growing and outnumbers what's left to find...near
+            //the end of a search few edges are left unexplored, and on a low-degree graph like the k-NN graph most
+            //unvisited nodes are far from a small frontier and check every edge they have, so either way scanning every
+            //node costs more than the frontier's own edges.
+            if (direction == BfsDirection::Auto) {
+                size_t frontierSize = levelEnd - levelBegin;
+                size_t frontierEdges = 0;
+                for (size_t i = levelBegin; i < levelEnd; ++i) {
+                    frontierEdges += getDegree(levels.nodes[i]);
+                }
+                bool growing = frontierSize > previousLevelSize;
+                if (!bottomUp && growing && frontierSize >= unexploredNodes &&
+                    frontierEdges > unexploredEdges / bottomUpRatio) {
+                    bottomUp = true;
+                } else if (bottomUp && frontierSize * topDownRatio < table.count) {
+                    bottomUp = false;
+                }
+            }
+
+            if (bottomUp) {
+                for (size_t i = levelBegin; i < levelEnd; ++i) {
+                    frontierBits[levels.nodes[i] >> 6] |= 1ULL << (levels.nodes[i] & 63);
+                }
+                for (uint32_t node = 0; node < table.count; ++node) {
+                    if (visited.isVisited(node)) {
+                        continue;
+                    }
+                    bool found = false;
+                    context.edgesExamined += findNeighbor(node, [&](uint32_t neighbor) {
+                        found = (frontierBits[neighbor >> 6] >> (neighbor & 63)) & 1;
+                        return found;
+                    });
+                    if (found) {
+                        visited.visit(node);
+                        levels.nodes.push_back(node);
+                    }
+                }
+                for (size_t i = levelBegin; i < levelEnd; ++i) {
+                    frontierBits[levels.nodes[i] >> 6] = 0;
+                }
+            } else {
+                for (size_t i = levelBegin; i < levelEnd; ++i) {
+                    context.edgesExamined += forEachNeighbor(levels.nodes[i], [&](uint32_t neighbor) {
+                        if (visited.visit(neighbor)) {
+                            levels.nodes.push_back(neighbor);
+                        }
+                    });
+                }
+            }
+
+            for (size_t i = levelEnd; i < levels.nodes.size(); ++i) {
+                size_t degree = getDegree(levels.nodes[i]);
+                unexploredEdges -= degree;
+                unexploredNodes -= degree > 0;
+            }
+            previousLevelSize = levelEnd - levelBegin;
+            levelBegin = levelEnd;
+        }
+        return levels;
+    }
+
+    //level-synchronous parallel version of levelBFS...each level's frontier is split across the pool's threads, which
+    //claim unvisited neighbors through an atomic bitmap so every node is added once. Each level holds the same nodes
+    //as levelBFS, though their order within the level depends on thread timing.
+    BfsLevels parallelBFS(const vector<uint32_t>& sources, ThreadPool& pool) {
+        build();
+        AtomicBitmap visited(table.count);
+
+        //one output buffer per thread, each on its own cache line.
+        struct alignas(64) LocalFrontier {
+            vector<uint32_t> nodes;
+        };
+        vector<LocalFrontier> found(pool.getThreadCount());
+
+        BfsLevels levels;
+        for (uint32_t source : sources) {
+            if (visited.claim(source)) {
+                levels.nodes.push_back(source);
+            }
+        }
+        size_t levelBegin = 0;
+        while (levelBegin < levels.nodes.size()) {
+            size_t levelEnd = levels.nodes.size();
+            levels.levelOffsets.push_back(levelEnd);
+            pool.parallelFor(levelEnd - levelBegin, 64, [&](size_t begin, size_t end, size_t worker) {
+                vector<uint32_t>& out = found[worker].nodes;
+                for (size_t i = levelBegin + begin; i < levelBegin + end; ++i) {
+                    forEachNeighbor(levels.nodes[i], [&](uint32_t neighbor) {
+                        if (visited.claim(neighbor)) {
+                            out.push_back(neighbor);
+                        }
+                    });
+                }
+            });
+            for (auto& local : found) {
+                levels.nodes.insert(levels.nodes.end(), local.nodes.begin(), local.nodes.end());
+                local.nodes.clear();
+            }
+            levelBegin = levelEnd;
+        }
+        return levels;
+    }
+
+    //work-stealing parallel DFS from one or more start nodes, visiting every reachable node exactly once...each worker
+    //works depth-first from the back of its own deque and steals from the front of another worker's deque when its
+    //own runs dry. Nodes are claimed through an atomic bitmap as they're discovered, so none is pushed twice, and the
+    //search ends once no claimed node is left waiting in a deque or being expanded.
+    ParallelDfsResult parallelDFS(const vector<uint32_t>& sources, ThreadPool& pool) {
+        build();
+        size_t workerCount = pool.getThreadCount();
+        AtomicBitmap visited(table.count);
+
+        struct alignas(64) WorkerDeque {
+            mutex lock;
+            deque<uint32_t> nodes;
+        };
+        struct alignas(64) WorkerOutput {
+            vector<uint32_t> nodes;
+        };
+        vector<WorkerDeque> deques(workerCount);
+        vector<WorkerOutput> outputs(workerCount);
+        atomic<size_t> pending{0};
+
+        ParallelDfsResult result;
+        result.workers.resize(workerCount);
+
+        //deals the start nodes out to the workers in turn.
+        size_t nextWorker = 0;
+        for (uint32_t source : sources) {
+            if (visited.claim(source)) {
+                deques[nextWorker++ % workerCount].nodes.push_back(source);
+                pending.fetch_add(1, memory_order_relaxed);
+            }
+        }
+
+        pool.run([&](size_t worker) {
+            WorkerDeque& own = deques[worker];
+            vector<uint32_t>& out = outputs[worker].nodes;
+            DfsWorkerStats stats;
+            vector<uint32_t> discovered;
+            size_t victim = worker;
+
+            while (pending.load(memory_order_acquire) > 0) {
+                uint32_t node = 0;
+                bool found = false;
+                {
+                    lock_guard<mutex> guard(own.lock);
+                    if (!own.nodes.empty()) {
+                        node = own.nodes.back();
+                        own.nodes.pop_back();
+                        found = true;
+                    }
+                }
+
+                //tries every other worker once, carrying on from the last one stolen from.
+                for (size_t attempt = 1; !found && attempt < workerCount; ++attempt) {
+                    victim = (victim + 1) % workerCount;
+                    if (victim == worker) {
+                        victim = (victim + 1) % workerCount;
+                    }
+                    lock_guard<mutex> guard(deques[victim].lock);
+                    if (!deques[victim].nodes.empty()) {
+                        node = deques[victim].nodes.front();
+                        deques[victim].nodes.pop_front();
+                        found = true;
+                        stats.steals++;
+                    }
+                }
+                if (!found) {
+                    stats.failedSteals++;
+                    this_thread::yield();
+                    continue;
+                }
+
+                stats.visited++;
+                out.push_back(node);
+                discovered.clear();
+                forEachNeighbor(node, [&](uint32_t neighbor) {
+                    if (visited.claim(neighbor)) {
+                        discovered.push_back(neighbor);
+                    }
+                });
+                if (!discovered.empty()) {
+                    pending.fetch_add(discovered.size(), memory_order_relaxed);
+                    lock_guard<mutex> guard(own.lock);
+                    own.nodes.insert(own.nodes.end(), discovered.begin(), discovered.end());
+                }
+                pending.fetch_sub(1, memory_order_release);
+            }
+            result.workers[worker] = stats;
+        });
+
+        for (auto& output : outputs) {
+            result.nodes.insert(result.nodes.end(), output.nodes.begin(), output.nodes.end());
+        }
+        return result;
+    }
+
+    //getter function that returns a vector of all artists' IDs in the graph, in node index order.
+    [[nodiscard]] vector<string_view> getIDs() const {
+        vector<string_view> ids;
+        ids.reserve(table.count);
+        for (uint32_t i = 0; i < table.count; ++i) {
+            ids.emplace_back(table.getId(i));
+        }
+        return ids;
+    }
+
+    [[nodiscard]] size_t getNodeCount() const {
+        return table.count;
+    }
+
+    //number of edges, counting every pair inside a clique.
+    [[nodiscard]] size_t getEdgeCount() const {
+        return edgeCount + cliqueEdgeCount;
+    }
+
+    //number of edges looked at by the last traversal on the calling thread.
+    [[nodiscard]] size_t getEdgesExamined() const {
+        return getTraversalContext().edgesExamined;
+    }
+
+    //bytes used to store the edges, including the cliques.
+    [[nodiscard]] size_t getAdjacencyMemory() const {
+        return offsets.capacity() * sizeof(uint64_t) + neighbors.capacity() * sizeof(uint32_t) +
+               pendingEdges.capacity() * sizeof(pair<uint32_t, uint32_t>) + cliqueOf.capacity() * sizeof(uint32_t) +
+               cliqueOffsets.capacity() * sizeof(uint64_t) + cliqueMembers.capacity() * sizeof(uint32_t);
+    }
+};
+
+//Genres offered on the welcome window.
+const vector<string> featuredGenres = {"hip hop", "folk rock", "pop rock", "orchestra", "r&b", "country"};
+
+//Builds a graph over the whole catalog where the artists sharing one genre form an implicit clique...the other
+//artists are left without edges.
+void buildGenreGraph(const ArtistCatalog& catalog, const string& genre, Graph& graph) {
+    graph = Graph(catalog.getTable());
+    uint32_t g;
+    if (catalog.findGenre(genre, g)) {
+        IndexRange members = catalog.getGenreMembers(g);
+        graph.addClique(vector<uint32_t>(members.begin(), members.end()));
+    }
+    graph.build();
+}
+
+//Default and largest number of similar artists each artist is connected to...--neighbors=N must be in between 1 and
+//maxNeighborCount, since past that every genre is close to a clique and the edge list alone runs to gigabytes.
+const int defaultNeighborCount = 5;
+const int maxNeighborCount = 100;
+
+//Most candidates an artist compares itself against while looking for its nearest neighbors...keeps the build
+//at O(n * limit) even when lots of artists share the same familiarity and hotttnesss.
+const int neighborScanLimit = 1024;
+
+//Similarity features of one artist, both ranging from 0.0 to 1.0.
+struct SimilarityPoint {
+    float familiarity;
+    float hotttnesss;
+    uint32_t node;
+};
+
+//Finds each point's k nearest points by familiarity and hotttnesss and returns every connection once, smaller node first.
+//Points are bucketed into a grid with about k points per cell, and each point searches rings of cells outward from its own
+//until the next ring is further away than its k-th best distance, so the build is O(n * k) instead of comparing every pair.
+//k is capped at one less than the number of points, since no point has more neighbors than that.
+vector<pair<uint32_t, uint32_t>> findNearestNeighborEdges(const vector<SimilarityPoint>& points, int k) {
+    vector<pair<uint32_t, uint32_t>> edges;
+    if (points.size() < 2 || k < 1) {
+        return edges;
+    }
+    k = static_cast<int>(min<size_t>(k, points.size() - 1));
+
+    int gridSize = max(1, static_cast<int>(sqrt(static_cast<double>(points.size()) / k)));
+    auto cellOf = [gridSize](float value) {
+        return min(gridSize - 1, max(0, static_cast<int>(value * static_cast<float>(gridSize))));
+    };
+
+    //counting sort of the points into cells...cell c holds cellPoints[cellStart[c]] to cellPoints[cellStart[c + 1] - 1].
+    vector<uint32_t> cellStart(gridSize * gridSize + 1, 0);
+    vector<uint32_t> cellPoints(points.size());
+    for (const auto& point : points) {
+        cellStart[cellOf(point.familiarity) * gridSize + cellOf(point.hotttnesss) + 1]++;
+    }
+    for (size_t cell = 0; cell + 1 < cellStart.size(); ++cell) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    vector<uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        cellPoints[next[cellOf(points[i].familiarity) * gridSize + cellOf(points[i].hotttnesss)]++] = i;
+    }
+
+    //max heap of (squared distance, point) holding the k best candidates so far...reused for every point.
+    vector<pair<float, uint32_t>> best;
+    best.reserve(k + 1);
+    edges.reserve(points.size() * k);
+
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        int cellX = cellOf(points[i].familiarity);
+        int cellY = cellOf(points[i].hotttnesss);
+        best.clear();
+        int scanned = 0;
+
+        for (int ring = 0; ring < gridSize && scanned < neighborScanLimit; ++ring) {
+            //every cell in this ring lies outside the square of cells already searched, so it's at least as far as that square's nearest edge.
+            float cellWidth = 1.0f / static_cast<float>(gridSize);
+            float ringDistance = 0.0f;
+            if (ring > 0) {
+                ringDistance = min(min(points[i].familiarity - static_cast<float>(cellX - ring + 1) * cellWidth,
+                                       static_cast<float>(cellX + ring) * cellWidth - points[i].familiarity),
+                                   min(points[i].hotttnesss - static_cast<float>(cellY - ring + 1) * cellWidth,
+                                       static_cast<float>(cellY + ring) * cellWidth - points[i].hotttnesss));
+                ringDistance = max(0.0f, ringDistance);
+            }
+            if (static_cast<int>(best.size()) == k && ringDistance * ringDistance >= best.front().first) {
+                break;
+            }
+
+            for (int x = cellX - ring; x <= cellX + ring; ++x) {
+                for (int y = cellY - ring; y <= cellY + ring; ++y) {
+                    bool onRing = abs(x - cellX) == ring || abs(y - cellY) == ring;
+                    if (!onRing || x < 0 || y < 0 || x >= gridSize || y >= gridSize) {
+                        continue;
+                    }
+                    int cell = x * gridSize + y;
+                    for (uint32_t slot = cellStart[cell]; slot < cellStart[cell + 1]; ++slot) {
+                        uint32_t candidate = cellPoints[slot];
+                        if (candidate == i) {
+                            continue;
+                        }
+                        float familiarityGap = points[i].familiarity - points[candidate].familiarity;
+                        float hotttnesssGap = points[i].hotttnesss - points[candidate].hotttnesss;
+                        float distance = familiarityGap * familiarityGap + hotttnesssGap * hotttnesssGap;
+                        if (static_cast<int>(best.size()) < k || distance < best.front().first) {
+                            best.emplace_back(distance, candidate);
+                            push_heap(best.begin(), best.end());
+                            if (static_cast<int>(best.size()) > k) {
+                                pop_heap(best.begin(), best.end());
+                                best.pop_back();
+                            }
+                        }
+                        scanned++;
+                    }
+                }
+            }
+        }
+
+        for (const auto& neighbor : best) {
+            uint32_t a = points[i].node;
+            uint32_t b = points[neighbor.second].node;
+            edges.emplace_back(min(a, b), max(a, b));
+        }
+    }
+
+    //two artists that picked each other would otherwise be connected twice.
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+//Builds the graph over the whole catalog...node i is catalog artist i, and every artist is connected to the
+//k artists sharing its genre (terms) with the closest familiarity and hotttnesss.
+//The fraction of artists connected so far is written to progress as each genre finishes.
+void buildArtistGraph(const ArtistCatalog& catalog, Graph& graph, int k, atomic<float>* progress = nullptr) {
+    graph = Graph(catalog.getTable());
+
+    size_t connected = 0;
+    for (uint32_t genre = 0; genre < catalog.getGenreCount(); ++genre) {
+        if (progress != nullptr) {
+            progress->store(static_cast<float>(connected) / max<size_t>(catalog.getArtistCount(), 1), memory_order_relaxed);
+        }
+        connected += catalog.getGenreSize(genre);
+
+        vector<SimilarityPoint> points;
+        for (uint32_t member : catalog.getGenreMembers(genre)) {
+            points.push_back({catalog.getFamiliarity(member), catalog.getHotttnesss(member), member});
+        }
+        for (const auto& edge : findNearestNeighborEdges(points, k)) {
+            graph.addEdge(edge.first, edge.second);
+        }
+    }
+    graph.build();
+}
+
+//Cancellation flag shared by whoever submitted a query and the thread running it.
+using CancelFlag = shared_ptr<atomic<bool>>;
+
+//Runs queries one at a time on a worker thread...submit() hands back a future straight away, so the UI thread
+//never waits on a traversal. Queries still queued when the executor is destroyed are run before it returns.
+class QueryExecutor {
+private:
+    mutex queueLock;
+    condition_variable wake;
+    deque<function<void()>> tasks;
+    bool stopping = false;
+    thread worker;
+
+    void run() {
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> guard(queueLock);
+                wake.wait(guard, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
 
 public:
-    //adds artist nodes to the graph.
-    void addArtist(const string& id, const json& artist) {
-        artists[id] = artist;
-        adjacencyList[id] = vector<string>();
+    QueryExecutor() : worker([this]() { run(); }) {}
+    QueryExecutor(const QueryExecutor&) = delete;
+    QueryExecutor& operator=(const QueryExecutor&) = delete;
+
+    ~QueryExecutor() {
+        {
+            lock_guard<mutex> guard(queueLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
     }
 
-    //creates an edge between artists.
-    void addEdge(const string& id1, const string& id2) {
-        adjacencyList[id1].push_back(id2);
-        adjacencyList[id2].push_back(id1);
+    //queues a task and returns a future for its result.
+    template <typename Task>
+    auto submit(Task task) -> future<decltype(task())> {
+        auto packaged = make_shared<packaged_task<decltype(task())()>>(move(task));
+        future<decltype(task())> result = packaged->get_future();
+        {
+            lock_guard<mutex> guard(queueLock);
+            tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        wake.notify_one();
+        return result;
     }
+};
 
-    //main breadth-first traversal function...takes in the starting node and returns recommended artists.
-    vector<string> BFS(const string& startId) {
-        queue<string> q;
-        unordered_set<string> visited;
-        vector<string> bfsResults;
-        int count = 0;
+//Everything a recommendation depends on...the welcome window always starts from the genre's first artist.
+struct RecommendationKey {
+    uint32_t genre;
+    TraversalOrder order;
+    RecommendationQuery query;
+
+    bool operator==(const RecommendationKey& other) const {
+        return genre == other.genre && order == other.order && query == other.query;
+    }
+};
 
-        q.push(startId);
-        visited.insert(startId);
+struct RecommendationKeyHash {
+    size_t operator()(const RecommendationKey& key) const {
+        auto order = static_cast<uint32_t>(key.order);
+        uint64_t hash = fnv1a(reinterpret_cast<const char*>(&key.genre), sizeof(key.genre));
+        hash = fnv1a(reinterpret_cast<const char*>(&order), sizeof(order), hash);
+        hash = fnv1a(reinterpret_cast<const char*>(&key.query.start), sizeof(key.query.start), hash);
+        hash = fnv1a(reinterpret_cast<const char*>(&key.query.threshold), sizeof(key.query.threshold), hash);
+        hash = fnv1a(reinterpret_cast<const char*>(&key.query.k), sizeof(key.query.k), hash);
+        return static_cast<size_t>(fnv1a(reinterpret_cast<const char*>(&key.query.maxDepth), sizeof(key.query.maxDepth), hash));
+    }
+};
 
-        //Only gives at most 5 recommended artists.
-        while (!q.empty() && count < 5) {
-            string currentId = q.front();
-            q.pop();
-            json currentArtist = artists[currentId];
+//Result of one recommendation query run by the executor.
+struct TraversalResult {
+    vector<string_view> artists;
+    double time = 0.0;
+    bool cancelled = false;
+};
 
-            //makes sure to only give niche artists with less than 0.5 familiarity score.
-            if (currentArtist["familiarity"].get<double>() < 0.5) {
-                bfsResults.push_back(currentArtist["name"]);
-                count++;
+//Runs and times one BFS, DFS or best-first search...if the cancel flag is set before it finishes, it stops early and comes
+//back marked as cancelled. Best-first stops once it holds the genre's k least familiar artists under the threshold,
+//since the similarity graph only links artists within a genre and nothing reachable can beat them.
+TraversalResult runTraversal(Graph& graph, const ArtistCatalog& catalog, const RecommendationKey& key, const atomic<bool>* cancelled) {
+    TraversalResult result;
+    const RecommendationQuery& query = key.query;
+    if (cancelled == nullptr || !cancelled->load(memory_order_relaxed)) {
+        auto start = chrono::high_resolution_clock::now();
+        switch (key.order) {
+            case TraversalOrder::BreadthFirst:
+                result.artists = graph.BFS(query, cancelled);
+                break;
+            case TraversalOrder::DepthFirst:
+                result.artists = graph.DFS(query, cancelled);
+                break;
+            case TraversalOrder::BestFirst: {
+                IndexRange nichest = catalog.getNichest(key.genre, query.threshold, query.k);
+                ScoredNode stopKey{-numeric_limits<float>::infinity(), 0, 0};
+                if (nichest.size() == query.k) {
+                    uint32_t last = *(nichest.end() - 1);
+                    stopKey = {catalog.getFamiliarity(last), last, 0};
+                }
+                result.artists = graph.bestFirst(query, cancelled, 0.0f, stopKey);
+                break;
             }
+            case TraversalOrder::PageRank:
+                result.artists = graph.personalizedPageRank(query, cancelled);
+                break;
+            case TraversalOrder::RandomWalk:
+                result.artists = graph.randomWalks(query, getSharedPool(), RandomWalkSettings{}, cancelled);
+                break;
+        }
+        auto end = chrono::high_resolution_clock::now();
+        result.time = chrono::duration<double, milli>(end - start).count();
+    }
+    result.cancelled = cancelled != nullptr && cancelled->load(memory_order_relaxed);
+    return result;
+}
+
+//Finished recommendation results, so clicking a genre again is a lookup instead of a traversal.
+//Entries hold views into the catalog, so the cache is tied to one data set and emptied when it changes.
+//Safe to use from several threads.
+class RecommendationCache {
+private:
+    mutable mutex entriesLock;
+    unordered_map<RecommendationKey, TraversalResult, RecommendationKeyHash> entries;
+    uint64_t dataset = 0;
+
+    atomic<size_t> hits{0};
+    atomic<size_t> misses{0};
+    double warmupTime = 0.0;
+
+public:
+    //ties the cache to a data set...every entry is dropped if it's a different one from before.
+    void setDataset(uint64_t datasetHash) {
+        lock_guard<mutex> guard(entriesLock);
+        if (datasetHash != dataset) {
+            entries.clear();
+            dataset = datasetHash;
+        }
+    }
+
+    //copies out a cached result and counts a hit, or counts a miss.
+    bool find(const RecommendationKey& key, TraversalResult& result) {
+        lock_guard<mutex> guard(entriesLock);
+        auto found = entries.find(key);
+        if (found == entries.end()) {
+            misses.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        hits.fetch_add(1, memory_order_relaxed);
+        result = found->second;
+        return true;
+    }
 
-            vector<string> neighbors = adjacencyList[currentId];
+    //saves a finished result...cancelled results are partial, so they're never stored.
+    void store(const RecommendationKey& key, const TraversalResult& result) {
+        if (result.cancelled) {
+            return;
+        }
+        lock_guard<mutex> guard(entriesLock);
+        entries[key] = result;
+    }
 
-            for (const auto& neighborId : neighbors) {
-                if (visited.find(neighborId) == visited.end()) {
-                    q.push(neighborId);
-                    visited.insert(neighborId);
+    //runs every traversal order from the first artist of every genre and stores the results, spreading the genres over
+    //one thread per core.
+    void warm(const ArtistCatalog& catalog, Graph& graph, float threshold, uint32_t k) {
+        auto start = chrono::high_resolution_clock::now();
+        setDataset(catalog.getDatasetHash());
+
+        //one task per genre and traversal order, handed out through a shared counter.
+        const size_t orderCount = allTraversalOrders.size();
+        size_t taskCount = static_cast<size_t>(catalog.getGenreCount()) * orderCount;
+        atomic<size_t> nextTask{0};
+        auto worker = [&]() {
+            for (size_t task = nextTask.fetch_add(1); task < taskCount; task = nextTask.fetch_add(1)) {
+                auto genre = static_cast<uint32_t>(task / orderCount);
+                IndexRange members = catalog.getGenreMembers(genre);
+                if (members.empty()) {
+                    continue;
                 }
+                TraversalOrder order = allTraversalOrders[task % orderCount];
+                uint32_t first = *members.begin();
+                RecommendationKey key{genre, order, {first, threshold, k}};
+                store(key, runTraversal(graph, catalog, key, nullptr));
             }
+        };
+
+        size_t threadCount = min<size_t>(max(1u, thread::hardware_concurrency()), max<size_t>(taskCount, 1));
+        vector<thread> workers;
+        for (size_t i = 1; i < threadCount; ++i) {
+            workers.emplace_back(worker);
         }
-        return bfsResults;
+        worker();
+        for (auto& workerThread : workers) {
+            workerThread.join();
+        }
+
+        auto end = chrono::high_resolution_clock::now();
+        warmupTime = chrono::duration<double, milli>(end - start).count();
+    }
+
+    [[nodiscard]] size_t getSize() const {
+        lock_guard<mutex> guard(entriesLock);
+        return entries.size();
+    }
+
+    [[nodiscard]] size_t getHits() const {
+        return hits.load(memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t getMisses() const {
+        return misses.load(memory_order_relaxed);
+    }
+
+    //time the last warm() took in milliseconds.
+    [[nodiscard]] double getWarmupTime() const {
+        return warmupTime;
+    }
+};
+
+//Answers a recommendation query from the cache with a future that's already ready, or queues it on the executor
+//and caches the result once it finishes...the graph and catalog must stay alive until the future is ready.
+future<TraversalResult> submitRecommendation(QueryExecutor& executor, RecommendationCache& cache, Graph& graph, const ArtistCatalog& catalog,
+                                             const RecommendationKey& key, CancelFlag cancel) {
+    TraversalResult cached;
+    if (cache.find(key, cached)) {
+        promise<TraversalResult> ready;
+        ready.set_value(move(cached));
+        return ready.get_future();
+    }
+    return executor.submit([&cache, &graph, &catalog, key, cancel]() {
+        TraversalResult result = runTraversal(graph, catalog, key, cancel.get());
+        cache.store(key, result);
+        return result;
+    });
+}
+
+//Runs BFS and DFS repeatedly from one artist and returns the edges examined per second for each.
+pair<double, double> timeTraversals(Graph& graph, uint32_t start) {
+    const int traversalRuns = 100;
+    RecommendationQuery query{start};
+    double traversalTimes[2] = {0.0, 0.0};
+    size_t traversalEdges[2] = {0, 0};
+
+    //repeats each traversal so the timings aren't lost in clock noise.
+    for (int algorithm = 0; algorithm < 2; ++algorithm) {
+        auto runStart = chrono::high_resolution_clock::now();
+        for (int run = 0; run < traversalRuns; ++run) {
+            if (algorithm == 0) {
+                graph.BFS(query);
+            } else {
+                graph.DFS(query);
+            }
+            traversalEdges[algorithm] += graph.getEdgesExamined();
+        }
+        auto runEnd = chrono::high_resolution_clock::now();
+        traversalTimes[algorithm] = chrono::duration<double>(runEnd - runStart).count();
+    }
+    return {traversalEdges[0] / traversalTimes[0], traversalEdges[1] / traversalTimes[1]};
+}
+
+//Runs 10,000 back-to-back BFS, DFS and best-first queries from different artists and prints the time, edges examined
+//and heap allocations per query when they are counted...best-first runs once exact and once with a hop penalty, which lets it prune.
+void benchmarkQueries(Graph& graph) {
+    const int queryCount = 10000;
+    const float benchmarkHopPenalty = 0.05f;
+    if (graph.getNodeCount() == 0) {
+        return;
+    }
+    vector<RecommendationQuery> queries;
+    queries.reserve(queryCount);
+    for (int query = 0; query < queryCount; ++query) {
+        queries.push_back({static_cast<uint32_t>((static_cast<size_t>(query) * 7919) % graph.getNodeCount())});
     }
 
-    //main depth-first traversal function with same input and output as BFS.
-    vector<string> DFS(const string& startId) {
-        stack<string> s;
-        unordered_set<string> visited;
-        vector<string> dfsResults;
-        int count = 0;
+    const char* names[] = {"BFS", "DFS", "best-first", "best-first (hop penalty 0.05)"};
+    for (int algorithm = 0; algorithm < 4; ++algorithm) {
+        size_t allocationsBefore = getAllocationCount();
+        size_t edges = 0;
+        auto start = chrono::high_resolution_clock::now();
+        for (const auto& query : queries) {
+            if (algorithm == 0) {
+                graph.BFS(query);
+            } else if (algorithm == 1) {
+                graph.DFS(query);
+            } else if (algorithm == 2) {
+                graph.bestFirst(query);
+            } else {
+                graph.bestFirst(query, nullptr, benchmarkHopPenalty);
+            }
+            edges += graph.getEdgesExamined();
+        }
+        auto end = chrono::high_resolution_clock::now();
+        size_t allocations = getAllocationCount() - allocationsBefore;
 
-        s.push(startId);
-        visited.insert(startId);
+        cout << names[algorithm] << " x " << queryCount << ": " << chrono::duration<double, micro>(end - start).count() / queryCount
+             << " us/query, " << static_cast<double>(edges) / queryCount << " edges/query"
+             << (countingAllocations ? ", " + to_string(static_cast<double>(allocations) / queryCount) + " allocations/query" : "") << endl;
+    }
+    if (!countingAllocations) {
+        cout << "Allocations per query not counted: configure with -DCOUNT_ALLOCATIONS=ON to count them" << endl;
+    }
+}
 
-        while (!s.empty() && count < 5) {
-            string currentId = s.top();
-            s.pop();
-            json currentArtist = artists[currentId];
+//Looks up the k nichest artists of every genre through the niche index and through a scan of the genre's posting list at
+//a few thresholds and result counts, and prints the time per lookup for each and whether they agree. Then times
+//best-first from each genre's first artist with and without the niche index's stop key.
+void benchmarkNicheIndex(const ArtistCatalog& catalog, Graph& graph) {
+    const int lookupRuns = 100;
+    const float thresholds[] = {0.1f, 0.25f, 0.5f, 0.75f};
+    const uint32_t counts[] = {5, 100};
+
+    cout << "Niche index (k nichest under a threshold, per genre lookup):" << endl;
+    vector<pair<float, uint32_t>> candidates;
+    for (float threshold : thresholds) {
+        for (uint32_t k : counts) {
+            bool agree = true;
+            double indexTime = 0.0;
+            double scanTime = 0.0;
+            for (uint32_t genre = 0; genre < catalog.getGenreCount(); ++genre) {
+                IndexRange nichest;
+                auto startIndex = chrono::high_resolution_clock::now();
+                for (int run = 0; run < lookupRuns; ++run) {
+                    nichest = catalog.getNichest(genre, threshold, k);
+                }
+                auto endIndex = chrono::high_resolution_clock::now();
+
+                vector<uint32_t> scanned;
+                for (int run = 0; run < lookupRuns; ++run) {
+                    candidates.clear();
+                    for (uint32_t member : catalog.getGenreMembers(genre)) {
+                        if (catalog.getFamiliarity(member) < threshold) {
+                            candidates.emplace_back(catalog.getFamiliarity(member), member);
+                        }
+                    }
+                    size_t kept = min<size_t>(k, candidates.size());
+                    partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end());
+                    scanned.clear();
+                    for (size_t i = 0; i < kept; ++i) {
+                        scanned.push_back(candidates[i].second);
+                    }
+                }
+                auto endScan = chrono::high_resolution_clock::now();
 
-            if (currentArtist["familiarity"].get<double>() < 0.5) {
-                dfsResults.push_back(currentArtist["name"]);
-                count++;
+                indexTime += chrono::duration<double, micro>(endIndex - startIndex).count() / lookupRuns;
+                scanTime += chrono::duration<double, micro>(endScan - endIndex).count() / lookupRuns;
+                agree = agree && equal(nichest.begin(), nichest.end(), scanned.begin(), scanned.end());
             }
+            size_t genreCount = max<size_t>(catalog.getGenreCount(), 1);
+            cout << "    threshold " << threshold << ", k = " << k << ": index " << indexTime / genreCount << " us, scan "
+                 << scanTime / genreCount << " us, results " << (agree ? "match" : "differ") << endl;
+        }
+    }
 
-            vector<string> neighbors = adjacencyList[currentId];
+    double seededTime = 0.0;
+    double unseededTime = 0.0;
+    bool agree = true;
+    for (uint32_t genre = 0; genre < catalog.getGenreCount(); ++genre) {
+        if (catalog.getGenreMembers(genre).empty()) {
+            continue;
+        }
+        RecommendationKey key{genre, TraversalOrder::BestFirst, {*catalog.getGenreMembers(genre).begin()}};
+        TraversalResult seeded = runTraversal(graph, catalog, key, nullptr);
+        auto start = chrono::high_resolution_clock::now();
+        vector<string_view> unseeded = graph.bestFirst(key.query);
+        auto end = chrono::high_resolution_clock::now();
+        seededTime += seeded.time;
+        unseededTime += chrono::duration<double, milli>(end - start).count();
+        agree = agree && seeded.artists == unseeded;
+    }
+    cout << "    best-first from every genre's first artist: " << seededTime << " ms with the niche index's stop key, "
+         << unseededTime << " ms without, results " << (agree ? "match" : "differ") << endl;
+}
 
-            for (const auto& neighborId : neighbors) {
-                if (visited.find(neighborId) == visited.end()) {
-                    s.push(neighborId);
-                    visited.insert(neighborId);
+//Recomputes every traversal order's recommendations for every genre at a range of thresholds and result counts without the cache,
+//as the results window does when its settings change, and prints the average and worst time per change against
+//the 16.7 ms a frame takes at 60 fps.
+void benchmarkSettingsChanges(const ArtistCatalog& catalog, Graph& graph) {
+    const uint32_t counts[] = {1, 5, 20, maxRecommendationCount};
+    size_t changes = 0;
+    double totalTime = 0.0;
+    double worstTime = 0.0;
+    for (uint32_t genre = 0; genre < catalog.getGenreCount(); ++genre) {
+        if (catalog.getGenreMembers(genre).empty()) {
+            continue;
+        }
+        for (int step = 1; step < 20; ++step) {
+            for (uint32_t k : counts) {
+                RecommendationQuery query{*catalog.getGenreMembers(genre).begin(), static_cast<float>(step) * 0.05f, k};
+                auto start = chrono::high_resolution_clock::now();
+                for (TraversalOrder order : allTraversalOrders) {
+                    runTraversal(graph, catalog, {genre, order, query}, nullptr);
                 }
+                auto end = chrono::high_resolution_clock::now();
+                double time = chrono::duration<double, milli>(end - start).count();
+                totalTime += time;
+                worstTime = max(worstTime, time);
+                changes++;
             }
         }
-        return dfsResults;
     }
+    cout << "Settings changes: " << changes << " thresholds and result counts recomputed, " << totalTime / max<size_t>(changes, 1)
+         << " ms on average and " << worstTime << " ms at worst for all " << allTraversalOrders.size() << " traversals (a frame is 16.7 ms)" << endl;
+}
 
-    //getter function that returns a vector of all artists' IDs in the graph.
-    [[nodiscard]] vector<string> getIDs() const {
-        vector<string> ids;
-        ids.reserve(artists.size());
-        for (const auto& pair : artists) {
-            ids.push_back(pair.first);
+//Recommends from 1, 10, 100 and 500 seed artists with one multi-source BFS and with one BFS per seed, and prints the
+//time for each and whether the multi-source hops match the distances a full multi-source levelBFS gives.
+void benchmarkMultiSource(const ArtistCatalog& catalog, Graph& graph) {
+    const int runs = 20;
+    if (graph.getNodeCount() == 0) {
+        return;
+    }
+    cout << "Multi-source BFS (" << maxRecommendationCount << " niche artists ranked by hops from the nearest seed):" << endl;
+    for (size_t seedCount : {1, 10, 100, 500}) {
+        vector<uint32_t> seeds;
+        for (size_t i = 0; i < seedCount; ++i) {
+            seeds.push_back(static_cast<uint32_t>((i * 7919 + 1) % graph.getNodeCount()));
         }
-        return ids;
+        RecommendationQuery query{0, defaultNicheThreshold, maxRecommendationCount};
+
+        vector<SeededRecommendation> results;
+        size_t edges = 0;
+        auto startMulti = chrono::high_resolution_clock::now();
+        for (int run = 0; run < runs; ++run) {
+            results = graph.multiSourceBFS(seeds, query);
+            edges = graph.getEdgesExamined();
+        }
+        auto endMulti = chrono::high_resolution_clock::now();
+
+        size_t perSeedEdges = 0;
+        auto startPerSeed = chrono::high_resolution_clock::now();
+        for (int run = 0; run < runs; ++run) {
+            perSeedEdges = 0;
+            for (uint32_t seed : seeds) {
+                query.start = seed;
+                graph.BFS(query);
+                perSeedEdges += graph.getEdgesExamined();
+            }
+        }
+        auto endPerSeed = chrono::high_resolution_clock::now();
+
+        //the first niche artists of the full sweep, seeds left out, have the hops the recommendations should have.
+        BfsLevels levels = graph.levelBFS(seeds);
+        vector<uint32_t> expectedHops;
+        for (size_t level = 1; level < levels.getLevelCount() && expectedHops.size() < query.k; ++level) {
+            for (uint32_t node : levels.getLevel(level)) {
+                if (catalog.getFamiliarity(node) < query.threshold && expectedHops.size() < query.k) {
+                    expectedHops.push_back(static_cast<uint32_t>(level));
+                }
+            }
+        }
+        bool match = results.size() == expectedHops.size();
+        for (size_t i = 0; match && i < results.size(); ++i) {
+            match = results[i].hops == expectedHops[i];
+        }
+
+        cout << "    " << seedCount << " seeds: " << chrono::duration<double, micro>(endMulti - startMulti).count() / runs << " us and " << edges
+             << " edges in one pass, " << chrono::duration<double, micro>(endPerSeed - startPerSeed).count() / runs << " us and " << perSeedEdges
+             << " edges with one BFS per seed, hops " << (match ? "match" : "differ") << endl;
     }
-};
+}
+
+//Finds paths between 1,000 pairs of artists in the same genre with the bidirectional search and with a BFS from one end
+//that stops at the other, and prints the nodes each expanded and whether the path lengths agree.
+void benchmarkPathQueries(const ArtistCatalog& catalog, Graph& graph) {
+    const size_t pairCount = 1000;
+    size_t bidirectionalExpanded = 0;
+    size_t oneSidedExpanded = 0;
+    size_t connected = 0;
+    size_t totalLength = 0;
+    bool agree = true;
+    double bidirectionalTime = 0.0;
+    double oneSidedTime = 0.0;
+    if (catalog.getGenreCount() == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < pairCount; ++i) {
+        IndexRange members = catalog.getGenreMembers(static_cast<uint32_t>(i % catalog.getGenreCount()));
+        if (members.empty()) {
+            continue;
+        }
+        uint32_t from = members.begin()[(i * 7919) % members.size()];
+        uint32_t to = members.begin()[(i * 104729 + 17) % members.size()];
+
+        auto startBidirectional = chrono::high_resolution_clock::now();
+        ArtistPath path = graph.findPath(from, to);
+        auto endBidirectional = chrono::high_resolution_clock::now();
+
+        //a node is expanded once the visitor lets the traversal go on past it.
+        size_t expanded = 0;
+        uint32_t oneSidedLength = UINT32_MAX;
+        graph.traverse<TraversalOrder::BreadthFirst>(from, [&](const NodeView& artist) {
+            if (artist.index == to) {
+                oneSidedLength = artist.depth;
+                return false;
+            }
+            expanded++;
+            return true;
+        });
+        auto endOneSided = chrono::high_resolution_clock::now();
+
+        bidirectionalTime += chrono::duration<double, micro>(endBidirectional - startBidirectional).count();
+        oneSidedTime += chrono::duration<double, micro>(endOneSided - endBidirectional).count();
+        bidirectionalExpanded += path.nodesExpanded;
+        oneSidedExpanded += expanded;
+        if (!path.nodes.empty()) {
+            connected++;
+            totalLength += path.nodes.size() - 1;
+        }
+        agree = agree && (path.nodes.empty() ? oneSidedLength == UINT32_MAX : path.nodes.size() - 1 == oneSidedLength);
+    }
+    cout << "Path queries: " << connected << " of " << pairCount << " same-genre pairs connected, " << static_cast<double>(totalLength) / max<size_t>(connected, 1)
+         << " hops on average" << endl;
+    cout << "    bidirectional BFS " << static_cast<double>(bidirectionalExpanded) / pairCount << " nodes expanded, " << bidirectionalTime / pairCount
+         << " us; one-sided BFS " << static_cast<double>(oneSidedExpanded) / pairCount << " nodes expanded, " << oneSidedTime / pairCount
+         << " us; path lengths " << (agree ? "match" : "differ") << endl;
+}
+
+//Runs personalized PageRank from 200 artists at several epsilons and prints the time, edges pushed along and how many
+//of the top 10 niche artists match a run at epsilon 1e-7, showing what each step of accuracy costs.
+void benchmarkPageRank(Graph& graph) {
+    const size_t startCount = 200;
+    const uint32_t topCount = 10;
+    const float referenceEpsilon = 1e-7f;
+    if (graph.getNodeCount() == 0) {
+        return;
+    }
+
+    vector<vector<string_view>> reference;
+    for (size_t i = 0; i < startCount; ++i) {
+        RecommendationQuery query{static_cast<uint32_t>((i * 7919) % graph.getNodeCount()), defaultNicheThreshold, topCount};
+        reference.push_back(graph.personalizedPageRank(query, nullptr, referenceEpsilon));
+    }
+
+    cout << "Personalized PageRank (restart " << defaultRestartProbability << ", top " << topCount << " niche artists vs epsilon " << referenceEpsilon << "):" << endl;
+    for (float epsilon : {1e-3f, 1e-4f, 1e-5f, 1e-6f}) {
+        size_t edges = 0;
+        size_t matched = 0;
+        size_t expected = 0;
+        auto start = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < startCount; ++i) {
+            RecommendationQuery query{static_cast<uint32_t>((i * 7919) % graph.getNodeCount()), defaultNicheThreshold, topCount};
+            vector<string_view> ranked = graph.personalizedPageRank(query, nullptr, epsilon);
+            edges += graph.getEdgesExamined();
+            for (const auto& name : ranked) {
+                matched += count(reference[i].begin(), reference[i].end(), name);
+            }
+            expected += reference[i].size();
+        }
+        auto end = chrono::high_resolution_clock::now();
+        cout << "    epsilon " << epsilon << ": " << chrono::duration<double, milli>(end - start).count() / startCount << " ms/query, "
+             << edges / startCount << " edges/query, " << 100.0 * static_cast<double>(matched) / max<size_t>(expected, 1) << "% of the top "
+             << topCount << " match" << endl;
+    }
+}
+
+//Takes Monte Carlo recommendations from a fixed set of artists at several walk lengths and thread counts, and prints
+//walks/s for each along with whether every thread count gave the same recommendations as one thread.
+void benchmarkRandomWalks(Graph& graph) {
+    const size_t startCount = 50;
+    const uint32_t topCount = 10;
+    if (graph.getNodeCount() == 0) {
+        return;
+    }
+
+    cout << "Random walks (" << RandomWalkSettings{}.walkCount << " walks per query, top " << topCount << " niche artists):" << endl;
+    for (uint32_t walkLength : {4u, 8u, 16u}) {
+        RandomWalkSettings settings;
+        settings.walkLength = walkLength;
+        vector<vector<string_view>> reference;
+        for (size_t threadCount : {1, 2, 4, 8}) {
+            ThreadPool pool(threadCount);
+            bool same = true;
+            auto start = chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < startCount; ++i) {
+                RecommendationQuery query{static_cast<uint32_t>((i * 7919) % graph.getNodeCount()), defaultNicheThreshold, topCount};
+                vector<string_view> ranked = graph.randomWalks(query, pool, settings);
+                if (threadCount == 1) {
+                    reference.push_back(move(ranked));
+                } else {
+                    same = same && ranked == reference[i];
+                }
+            }
+            auto end = chrono::high_resolution_clock::now();
+            double seconds = chrono::duration<double>(end - start).count();
+            cout << "    length " << walkLength << ", " << threadCount << " thread(s): "
+                 << static_cast<double>(startCount) * settings.walkCount / seconds << " walks/s, " << 1000.0 * seconds / startCount
+                 << " ms/query" << (threadCount == 1 ? "" : same ? ", same as 1 thread" : ", DIFFERENT from 1 thread") << endl;
+        }
+    }
+}
+
+//true if both searches reached the same nodes at every level, ignoring their order within a level.
+bool sameLevels(const BfsLevels& first, const BfsLevels& second) {
+    if (first.getLevelCount() != second.getLevelCount()) {
+        return false;
+    }
+    for (size_t level = 0; level < first.getLevelCount(); ++level) {
+        vector<uint32_t> a(first.getLevel(level).begin(), first.getLevel(level).end());
+        vector<uint32_t> b(second.getLevel(level).begin(), second.getLevel(level).end());
+        sort(a.begin(), a.end());
+        sort(b.begin(), b.end());
+        if (a != b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//first artist of every genre...a BFS from all of them covers every component of the similarity graph.
+vector<uint32_t> getGenreStarts(const ArtistCatalog& catalog) {
+    vector<uint32_t> starts;
+    for (uint32_t genre = 0; genre < catalog.getGenreCount(); ++genre) {
+        if (!catalog.getGenreMembers(genre).empty()) {
+            starts.push_back(*catalog.getGenreMembers(genre).begin());
+        }
+    }
+    return starts;
+}
+
+//Runs the direction-optimizing BFS forced top-down, forced bottom-up and switching on its own, and prints the edges
+//each one examined, its time and whether its levels match levelBFS.
+void benchmarkBfsDirections(Graph& graph, const vector<uint32_t>& sources) {
+    BfsLevels expected = graph.levelBFS(sources);
+    const pair<BfsDirection, const char*> directions[] = {
+        {BfsDirection::TopDown, "top-down "}, {BfsDirection::BottomUp, "bottom-up"}, {BfsDirection::Auto, "auto     "}};
+    for (const auto& direction : directions) {
+        auto start = chrono::high_resolution_clock::now();
+        BfsLevels levels = graph.directionOptimizingBFS(sources, direction.first);
+        auto end = chrono::high_resolution_clock::now();
+        cout << "    " << direction.second << " BFS: " << graph.getEdgesExamined() << " edges examined in "
+             << chrono::duration<double, milli>(end - start).count() << " ms, levels " << (sameLevels(expected, levels) ? "match" : "differ") << endl;
+    }
+}
+
+//Sweeps the whole graph with the parallel BFS at 1, 2, 4, 8 and 16 threads, starting from the first artist of every
+//genre so every component is covered, and prints the speedup over one thread and whether the levels match levelBFS.
+void benchmarkParallelBFS(const ArtistCatalog& catalog, Graph& graph) {
+    const int sweepRuns = 20;
+    vector<uint32_t> sources = getGenreStarts(catalog);
+
+    auto startSerial = chrono::high_resolution_clock::now();
+    BfsLevels serial;
+    for (int run = 0; run < sweepRuns; ++run) {
+        serial = graph.levelBFS(sources);
+    }
+    auto endSerial = chrono::high_resolution_clock::now();
+    cout << "Full-graph BFS: " << serial.nodes.size() << " nodes in " << serial.getLevelCount() << " levels, serial "
+         << chrono::duration<double, milli>(endSerial - startSerial).count() / sweepRuns << " ms (" << thread::hardware_concurrency()
+         << " hardware threads)" << endl;
+
+    double oneThreadTime = 0.0;
+    for (size_t threadCount : {1, 2, 4, 8, 16}) {
+        ThreadPool pool(threadCount);
+        BfsLevels parallel;
+        auto start = chrono::high_resolution_clock::now();
+        for (int run = 0; run < sweepRuns; ++run) {
+            parallel = graph.parallelBFS(sources, pool);
+        }
+        auto end = chrono::high_resolution_clock::now();
+        double time = chrono::duration<double, milli>(end - start).count() / sweepRuns;
+        if (threadCount == 1) {
+            oneThreadTime = time;
+        }
+        cout << "    " << threadCount << " threads: " << time << " ms, " << oneThreadTime / time << "x speedup, levels "
+             << (sameLevels(serial, parallel) ? "match" : "differ") << endl;
+    }
+}
+
+//Sweeps the whole graph with the work-stealing parallel DFS at 1, 2, 4, 8 and 16 threads and prints the time, whether
+//every reachable node was visited exactly once, and each worker's visits and steals.
+void benchmarkParallelDFS(const ArtistCatalog& catalog, Graph& graph) {
+    const int sweepRuns = 20;
+    vector<uint32_t> sources = getGenreStarts(catalog);
+    size_t reachable = graph.levelBFS(sources).nodes.size();
+    cout << "Full-graph work-stealing DFS over " << reachable << " reachable nodes:" << endl;
+
+    double oneThreadTime = 0.0;
+    for (size_t threadCount : {1, 2, 4, 8, 16}) {
+        ThreadPool pool(threadCount);
+        ParallelDfsResult result;
+        auto start = chrono::high_resolution_clock::now();
+        for (int run = 0; run < sweepRuns; ++run) {
+            result = graph.parallelDFS(sources, pool);
+        }
+        auto end = chrono::high_resolution_clock::now();
+        double time = chrono::duration<double, milli>(end - start).count() / sweepRuns;
+        if (threadCount == 1) {
+            oneThreadTime = time;
+        }
+
+        vector<uint32_t> sorted = result.nodes;
+        sort(sorted.begin(), sorted.end());
+        bool once = sorted.size() == reachable && adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+        cout << "    " << threadCount << " threads: " << time << " ms, " << oneThreadTime / time << "x speedup, "
+             << (once ? "every node visited once" : "visits don't match") << ", visits/steals per worker:";
+        for (const auto& worker : result.workers) {
+            cout << " " << worker.visited << "/" << worker.steals;
+        }
+        cout << endl;
+    }
+}
+
+//Reads artist IDs from a file, one per line, and prints the niche artists closest to them on the similarity graph,
+//nearest first...used by --liked=FILE. Returns the exit code.
+int recommendFromLiked(const ArtistCatalog& catalog, const string& likedPath, int neighborCount) {
+    ifstream likedFile(likedPath);
+    if (!likedFile.is_open()) {
+        cerr << "Could not open " << likedPath << endl;
+        return 1;
+    }
+    Graph graph;
+    buildArtistGraph(catalog, graph, neighborCount);
+
+    vector<uint32_t> seeds;
+    size_t unknown = 0;
+    string line;
+    while (getline(likedFile, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos) {
+            continue;
+        }
+        size_t last = line.find_last_not_of(" \t\r");
+        uint32_t node;
+        if (graph.findIndex(string_view(line).substr(first, last - first + 1), node)) {
+            seeds.push_back(node);
+        } else {
+            unknown++;
+        }
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    vector<SeededRecommendation> recommendations = graph.multiSourceBFS(seeds, RecommendationQuery{});
+    auto end = chrono::high_resolution_clock::now();
+    cout << seeds.size() << " liked artists (" << unknown << " not found), " << recommendations.size() << " recommendations in "
+         << chrono::duration<double, micro>(end - start).count() << " us:" << endl;
+    for (const auto& recommendation : recommendations) {
+        cout << "    " << recommendation.name << " (" << recommendation.hops << (recommendation.hops == 1 ? " hop" : " hops") << " away)" << endl;
+    }
+    return 0;
+}
+
+//Prints the shortest chain of similar artists between two artist IDs given as "FROM,TO", with the nodes the
+//bidirectional search expanded...used by --path. Returns the exit code.
+int printPath(const ArtistCatalog& catalog, const string& endpoints, int neighborCount) {
+    size_t comma = endpoints.find(',');
+    if (comma == string::npos) {
+        cerr << "Expected --path=FROM_ID,TO_ID" << endl;
+        return 1;
+    }
+    Graph graph;
+    buildArtistGraph(catalog, graph, neighborCount);
+
+    uint32_t from;
+    uint32_t to;
+    if (!graph.findIndex(string_view(endpoints).substr(0, comma), from) || !graph.findIndex(string_view(endpoints).substr(comma + 1), to)) {
+        cerr << "Artist not found" << endl;
+        return 1;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    ArtistPath path = graph.findPath(from, to);
+    auto end = chrono::high_resolution_clock::now();
+    if (path.nodes.empty()) {
+        cout << "Not connected";
+    } else {
+        cout << path.nodes.size() - 1 << (path.nodes.size() == 2 ? " hop" : " hops");
+    }
+    cout << ", " << path.nodesExpanded << " nodes expanded and " << path.edgesExamined << " edges examined in "
+         << chrono::duration<double, micro>(end - start).count() << " us" << endl;
+    for (uint32_t node : path.nodes) {
+        cout << "    " << catalog.getTable().getName(node) << " (familiarity " << catalog.getFamiliarity(node) << ")" << endl;
+    }
+    return 0;
+}
+
+//Times graph building and traversals on the genre cliques and the k nearest neighbor graph and prints the results...used by --bench.
+void runBenchmarks(const ArtistCatalog& catalog, int neighborCount) {
+    cout << "Catalog: " << catalog.getArtistCount() << " artists in " << catalog.getGenreCount() << " genres loaded in " << catalog.getLoadTime() << " ms"
+         << describeAllocations(catalog.getLoadAllocations()) << endl;
+
+    //per-artist footprint of the columns against one Artist struct, which still needs its strings stored somewhere else.
+    const ArtistTable& table = catalog.getTable();
+    size_t artists = max<size_t>(table.count, 1);
+    cout << "Artist table: " << static_cast<double>(table.getMemoryUsage()) / artists << " bytes/artist ("
+         << ArtistTable::getColumnBytesPerArtist() << " in columns, " << static_cast<double>(table.getMemoryUsage()) / artists - ArtistTable::getColumnBytesPerArtist()
+         << " in ID and name characters), Artist struct " << sizeof(Artist) << " bytes/artist before its strings" << endl;
+
+    Graph similarityGraph;
+    size_t allocationsBefore = getAllocationCount();
+    auto startSimilarity = chrono::high_resolution_clock::now();
+    buildArtistGraph(catalog, similarityGraph, neighborCount);
+    auto endSimilarity = chrono::high_resolution_clock::now();
+    cout << "k-NN graph (k = " << neighborCount << "): " << similarityGraph.getNodeCount() << " nodes, " << similarityGraph.getEdgeCount()
+         << " edges, built in " << chrono::duration<double, milli>(endSimilarity - startSimilarity).count() << " ms"
+         << describeAllocations(getAllocationCount() - allocationsBefore) << ", "
+         << static_cast<double>(similarityGraph.getAdjacencyMemory()) / max<size_t>(similarityGraph.getEdgeCount(), 1) << " bytes/edge" << endl;
+    cout << "String pool: " << getStringPool().getCount() << " strings, " << getStringPool().getMemoryUsage() << " bytes" << endl;
+    benchmarkQueries(similarityGraph);
+    benchmarkNicheIndex(catalog, similarityGraph);
+    benchmarkSettingsChanges(catalog, similarityGraph);
+    benchmarkMultiSource(catalog, similarityGraph);
+    benchmarkPathQueries(catalog, similarityGraph);
+    benchmarkPageRank(similarityGraph);
+    benchmarkRandomWalks(similarityGraph);
+    benchmarkParallelBFS(catalog, similarityGraph);
+    benchmarkBfsDirections(similarityGraph, getGenreStarts(catalog));
+    benchmarkParallelDFS(catalog, similarityGraph);
+
+    //warms the recommendation cache, then looks up every traversal for every featured genre.
+    RecommendationCache cache;
+    cache.warm(catalog, similarityGraph, defaultNicheThreshold, defaultRecommendationCount);
+    auto startLookups = chrono::high_resolution_clock::now();
+    for (const auto& genre : featuredGenres) {
+        uint32_t g;
+        if (catalog.findGenre(genre, g) && catalog.getGenreSize(g) > 0) {
+            uint32_t first = *catalog.getGenreMembers(g).begin();
+            TraversalResult result;
+            for (TraversalOrder order : allTraversalOrders) {
+                cache.find({g, order, {first}}, result);
+            }
+        }
+    }
+    auto endLookups = chrono::high_resolution_clock::now();
+    cout << "Recommendation cache: " << cache.getSize() << " results warmed in " << cache.getWarmupTime() << " ms, " << cache.getHits() << " hits and "
+         << cache.getMisses() << " misses for the featured genres in " << chrono::duration<double, micro>(endLookups - startLookups).count() << " us" << endl;
+
+    for (const auto& genre : featuredGenres) {
+        Graph graph;
+        auto startBuild = chrono::high_resolution_clock::now();
+        buildGenreGraph(catalog, genre, graph);
+        auto endBuild = chrono::high_resolution_clock::now();
+        uint32_t g;
+        if (!catalog.findGenre(genre, g) || catalog.getGenreSize(g) == 0) {
+            cout << genre << ": no artists" << endl;
+            continue;
+        }
+        uint32_t first = *catalog.getGenreMembers(g).begin();
+
+        auto cliqueSpeed = timeTraversals(graph, first);
+        auto similaritySpeed = timeTraversals(similarityGraph, first);
+        cout << genre << ": " << catalog.getGenreSize(genre) << " artists in the genre index, clique of " << graph.getEdgeCount() << " edges built in "
+             << chrono::duration<double, milli>(endBuild - startBuild).count() << " ms, "
+             << static_cast<double>(graph.getAdjacencyMemory()) / max<size_t>(graph.getEdgeCount(), 1) << " bytes/edge" << endl;
+        cout << "    clique BFS " << cliqueSpeed.first / 1e6 << " M edges/s, DFS " << cliqueSpeed.second / 1e6 << " M edges/s" << endl;
+        cout << "    k-NN   BFS " << similaritySpeed.first / 1e6 << " M edges/s, DFS " << similaritySpeed.second / 1e6 << " M edges/s" << endl;
+        cout << "    clique graph, full sweep from the genre's first artist:" << endl;
+        benchmarkBfsDirections(graph, {*catalog.getGenreMembers(g).begin()});
+    }
+}
 
 
+//Queues the given traversals for one genre at a familiarity threshold and result count and returns their futures in
+//the same order...called again whenever a setting changes.
+using RecommendationSubmitter = function<vector<future<TraversalResult>>(const vector<TraversalOrder>& orders, float threshold, uint32_t k)>;
+
+//Name shown above a traversal's column.
+string getOrderName(TraversalOrder order) {
+    switch (order) {
+        case TraversalOrder::BreadthFirst:
+            return "BFS";
+        case TraversalOrder::DepthFirst:
+            return "DFS";
+        case TraversalOrder::BestFirst:
+            return "Best-First";
+        case TraversalOrder::PageRank:
+            return "PageRank";
+        case TraversalOrder::RandomWalk:
+            return "Random Walk";
+    }
+    return "";
+}
+
 //Creates the recommendations window and all properties.
-//Takes in artist recs and time comparisons.
-void displayRecommendations(const vector<string>& bfsResults, const vector<string>& dfsResults, double bfsTime, double dfsTime, bool &goBackToHome) {
+//Submits the BFS, DFS and best-first queries and fills each column in as its results arrive. Clicking the third
+//column's title switches it to the next ranking after BFS and DFS. The threshold slider, the result count field and
+//the switch resubmit straight away, answered from the graph already in memory...clicking home or closing the window
+//cancels whatever is still running. clickTime is when the genre was clicked, used to show the time
+//to the first frame.
+void displayRecommendations(const RecommendationSubmitter& submit, const CancelFlag& cancel,
+                            chrono::high_resolution_clock::time_point clickTime, bool &goBackToHome) {
     //sets font.
     Font font;
     font.loadFromFile("files/otherFont.ttf");
@@ -146,118 +3351,398 @@ void displayRecommendations(const vector<string>& bfsResults, const vector<strin
     Sprite homeButton(home);
     homeButton.setPosition(25, 525);
 
+    //one column per traversal, left to right...the last one can be switched between the rankings after BFS and DFS.
+    const int columnCount = 3;
+    vector<TraversalOrder> orders = {TraversalOrder::BreadthFirst, TraversalOrder::DepthFirst, TraversalOrder::BestFirst};
+    //most artists listed in a column...any more are counted underneath.
+    const size_t visibleRows = 6;
+
     //box outlines properties.
-    float resultsBoxWidth = 350;
-    float resultsBoxHeight = 400;
-    float resultsBoxY = 120;
-
-    RectangleShape bfsResultsBox;
-    bfsResultsBox.setSize(Vector2f(resultsBoxWidth, resultsBoxHeight));
-    bfsResultsBox.setFillColor(Color(80, 80, 80, 100));
-    bfsResultsBox.setOutlineThickness(2);
-    bfsResultsBox.setOutlineColor(Color::White);
-    bfsResultsBox.setPosition(50, resultsBoxY);
-
-    RectangleShape dfsResultsBox;
-    dfsResultsBox.setSize(Vector2f(resultsBoxWidth, resultsBoxHeight));
-    dfsResultsBox.setFillColor(Color(80, 80, 80, 100));
-    dfsResultsBox.setOutlineThickness(2);
-    dfsResultsBox.setOutlineColor(Color::White);
-    dfsResultsBox.setPosition(400, resultsBoxY);
-
-    //handles events of clicking the home button and closing the window.
+    float resultsBoxWidth = 700.0f / columnCount;
+    float resultsBoxHeight = 390;
+    float resultsBoxY = 110;
+
+    RectangleShape resultsBoxes[columnCount];
+    for (int column = 0; column < columnCount; ++column) {
+        resultsBoxes[column].setSize(Vector2f(resultsBoxWidth, resultsBoxHeight));
+        resultsBoxes[column].setFillColor(Color(80, 80, 80, 100));
+        resultsBoxes[column].setOutlineThickness(2);
+        resultsBoxes[column].setOutlineColor(Color::White);
+        resultsBoxes[column].setPosition(50 + column * resultsBoxWidth, resultsBoxY);
+    }
+
+    //familiarity threshold slider, from 0 on the left to 1 on the right.
+    float sliderX = 110;
+    float sliderY = 560;
+    float sliderWidth = 200;
+    RectangleShape sliderTrack(Vector2f(sliderWidth, 6));
+    sliderTrack.setFillColor(Color(60, 60, 60));
+    sliderTrack.setPosition(sliderX, sliderY - 3);
+    CircleShape sliderKnob(9);
+    sliderKnob.setOrigin(9, 9);
+    sliderKnob.setFillColor(Color::White);
+
+    //result count field, typed into after clicking it.
+    RectangleShape countField(Vector2f(50, 30));
+    countField.setFillColor(Color(80, 80, 80, 100));
+    countField.setOutlineThickness(2);
+    countField.setPosition(440, sliderY - 15);
+
+    float threshold = defaultNicheThreshold;
+    uint32_t k = defaultRecommendationCount;
+    string countInput = to_string(k);
+    bool draggingSlider = false;
+    bool editingCount = false;
+
+    //results so far, filled in as each query finishes...the last results stay up until new ones replace them.
+    vector<future<TraversalResult>> queries = submit(orders, threshold, k);
+    TraversalResult results[columnCount];
+    bool ready[columnCount] = {false, false, false};
+    bool received[columnCount] = {false, false, false};
+    double firstFrameTime = -1.0;
+    //time from the last settings change until all three columns were up to date.
+    auto changeTime = chrono::high_resolution_clock::now();
+    bool settingsChanged = false;
+    double updateTime = -1.0;
+
+    //asks for new results after the threshold, result count or ranking changes.
+    auto resubmit = [&]() {
+        queries = submit(orders, threshold, k);
+        fill(begin(ready), end(ready), false);
+        changeTime = chrono::high_resolution_clock::now();
+        settingsChanged = true;
+        updateTime = -1.0;
+    };
+
+    //moves the slider to the mouse, in steps of 0.01, and resubmits if the threshold changed.
+    auto slideTo = [&](float mouseX) {
+        float position = min(1.0f, max(0.0f, (mouseX - sliderX) / sliderWidth));
+        float newThreshold = round(position * 100.0f) / 100.0f;
+        if (newThreshold != threshold) {
+            threshold = newThreshold;
+            resubmit();
+        }
+    };
+
+    //takes the typed result count once it's a number from 1 to maxRecommendationCount.
+    auto applyCount = [&]() {
+        if (countInput.empty()) {
+            return;
+        }
+        auto newCount = static_cast<uint32_t>(min<unsigned long>(stoul(countInput), maxRecommendationCount));
+        if (newCount >= 1 && newCount != k) {
+            k = newCount;
+            resubmit();
+        }
+    };
+
+    //handles events of clicking the home button, the slider and the result count field, and closing the window.
     while (recs.isOpen()) {
         Event event{};
         while (recs.pollEvent(event)) {
             if (event.type == Event::Closed) {
+                cancel->store(true, memory_order_relaxed);
                 recs.close();
             } else if (event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Left) {
                 Vector2f mousePosition = recs.mapPixelToCoords(Mouse::getPosition(recs));
+                editingCount = countField.getGlobalBounds().contains(mousePosition);
                 if (homeButton.getGlobalBounds().contains(mousePosition)) {
+                    cancel->store(true, memory_order_relaxed);
                     goBackToHome = true;
                     recs.close();
+                } else if (mousePosition.x >= sliderX - 10 && mousePosition.x <= sliderX + sliderWidth + 10 &&
+                           abs(mousePosition.y - sliderY) <= 12) {
+                    draggingSlider = true;
+                    slideTo(mousePosition.x);
+                } else if (mousePosition.x >= 50 + (columnCount - 1) * resultsBoxWidth && mousePosition.x <= 50 + columnCount * resultsBoxWidth &&
+                           mousePosition.y >= resultsBoxY && mousePosition.y <= resultsBoxY + 50) {
+                    //cycles through the orders after BFS and DFS.
+                    auto current = find(allTraversalOrders.begin(), allTraversalOrders.end(), orders.back());
+                    orders.back() = next(current) == allTraversalOrders.end() ? allTraversalOrders[2] : *next(current);
+                    received[columnCount - 1] = false;
+                    resubmit();
+                }
+            } else if (event.type == Event::MouseMoved && draggingSlider) {
+                slideTo(recs.mapPixelToCoords(Vector2i(event.mouseMove.x, event.mouseMove.y)).x);
+            } else if (event.type == Event::MouseButtonReleased && event.mouseButton.button == Mouse::Left) {
+                draggingSlider = false;
+            } else if (event.type == Event::TextEntered && editingCount) {
+                //digits edit the count as they're typed, backspace deletes and enter finishes.
+                if (event.text.unicode >= '0' && event.text.unicode <= '9' && countInput.size() < 2) {
+                    countInput += static_cast<char>(event.text.unicode);
+                    applyCount();
+                } else if (event.text.unicode == '\b' && !countInput.empty()) {
+                    countInput.pop_back();
+                    applyCount();
+                } else if (event.text.unicode == '\r') {
+                    editingCount = false;
                 }
             }
         }
+        if (!editingCount) {
+            countInput = to_string(k);
+        }
+
+        //picks up results without blocking the window.
+        bool allReady = true;
+        for (int column = 0; column < columnCount; ++column) {
+            if (!ready[column] && queries[column].wait_for(chrono::seconds(0)) == future_status::ready) {
+                results[column] = queries[column].get();
+                ready[column] = true;
+                received[column] = true;
+            }
+            allReady = allReady && ready[column];
+        }
+        if (allReady && settingsChanged && updateTime < 0.0) {
+            updateTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - changeTime).count();
+        }
 
         //clearing and drawing window.
         recs.clear(Color(98, 122, 157));
         recs.draw(homeButton);
         recs.draw(border);
-        recs.draw(bfsResultsBox);
-        recs.draw(dfsResultsBox);
+        for (const auto& resultsBox : resultsBoxes) {
+            recs.draw(resultsBox);
+        }
 
         //Creating window text.
         Text recTitle("Artist Recommendations", font, 40);
         recTitle.setFillColor(Color::White);
-        setText(recTitle, 400, 65);
+        setText(recTitle, 400, 60);
         recs.draw(recTitle);
 
-        Text bfsTitle("BFS Results:", font, 30);
-        bfsTitle.setFillColor(Color::White);
-        bfsTitle.setStyle(Text::Underlined);
-        setText(bfsTitle, 225, resultsBoxY + 20);
-        recs.draw(bfsTitle);
-
-        //Creates text for each artist in the BFS vector.
-        float yBfs = resultsBoxY + 75;
-        for (const auto& name : bfsResults) {
-            Text artistName(name, font, 20);
-            artistName.setFillColor(Color::White);
-            setText(artistName, 225, yBfs);
-            recs.draw(artistName);
-            yBfs += 40;
-        }
-
-        Text dfsTitle("DFS Results:", font, 30);
-        dfsTitle.setStyle(Text::Underlined);
-        dfsTitle.setFillColor(Color::White);
-        setText(dfsTitle, 575, resultsBoxY + 20);
-        recs.draw(dfsTitle);
-
-        float yDfs = resultsBoxY + 75;
-        for (const auto& name : dfsResults) {
-            Text artistName(name, font, 20);
-            artistName.setFillColor(Color::White);
-            setText(artistName, 575, yDfs);
-            recs.draw(artistName);
-            yDfs += 40;
-        }
-
-        //Displays traversal execution times.
-        Text bfsTimeText("BFS Time: " + to_string(bfsTime) + " ms", font, 20);
-        Text dfsTimeText("DFS Time: " + to_string(dfsTime) + " ms", font, 20);
+        //Sets the fastest time to green and the slowest time to red once all are in.
+        int fastest = 0;
+        int slowest = 0;
+        for (int column = 1; column < columnCount; ++column) {
+            if (results[column].time < results[fastest].time) {
+                fastest = column;
+            }
+            if (results[column].time > results[slowest].time) {
+                slowest = column;
+            }
+        }
         auto lightRed = Color(255,127,127);
         auto lightGreen = Color(144,238,144);
 
-        //Sets the faster time to green and the slower time to red.
-        if (bfsTime < dfsTime) {
-            bfsTimeText.setFillColor(lightGreen);
-            dfsTimeText.setFillColor(lightRed);
-        } else {
-            bfsTimeText.setFillColor(lightRed);
-            dfsTimeText.setFillColor(lightGreen);
-        }
+        for (int column = 0; column < columnCount; ++column) {
+            float centerX = 50 + (column + 0.5f) * resultsBoxWidth;
+
+            Text title(getOrderName(orders[column]) + " Results:", font, 24);
+            title.setFillColor(Color::White);
+            title.setStyle(Text::Underlined);
+            setText(title, centerX, resultsBoxY + 20);
+            recs.draw(title);
+            if (column == columnCount - 1) {
+                Text switchHint("(click to switch)", font, 12);
+                switchHint.setFillColor(Color::White);
+                setText(switchHint, centerX, resultsBoxY + 42);
+                recs.draw(switchHint);
+            }
+
+            //Creates text for each recommended artist, or a placeholder until the first results arrive.
+            float y = resultsBoxY + 75;
+            if (!received[column]) {
+                Text searching("Searching...", font, 18);
+                searching.setFillColor(Color::White);
+                setText(searching, centerX, y);
+                recs.draw(searching);
+                continue;
+            }
+            const vector<string_view>& artists = results[column].artists;
+            for (size_t row = 0; row < artists.size() && row < visibleRows; ++row) {
+                Text artistName(string(artists[row]), font, 18);
+                artistName.setFillColor(Color::White);
+                setText(artistName, centerX, y);
+                recs.draw(artistName);
+                y += 40;
+            }
+            if (artists.size() > visibleRows) {
+                Text more("...and " + to_string(artists.size() - visibleRows) + " more", font, 16);
+                more.setFillColor(Color::White);
+                setText(more, centerX, y);
+                recs.draw(more);
+                y += 40;
+            } else if (artists.empty()) {
+                Text none("No artists found", font, 18);
+                none.setFillColor(Color::White);
+                setText(none, centerX, y);
+                recs.draw(none);
+                y += 40;
+            }
 
-        setText(bfsTimeText, 225, yBfs + 20);
-        recs.draw(bfsTimeText);
+            //Displays the traversal's execution time.
+            Text timeText(getOrderName(orders[column]) + " Time: " + to_string(results[column].time) + " ms", font, 16);
+            if (!allReady) {
+                timeText.setFillColor(Color::White);
+            } else if (column == fastest) {
+                timeText.setFillColor(lightGreen);
+            } else if (column == slowest) {
+                timeText.setFillColor(lightRed);
+            } else {
+                timeText.setFillColor(Color::White);
+            }
+            setText(timeText, centerX, y + 20);
+            recs.draw(timeText);
+        }
 
-        setText(dfsTimeText, 575, yDfs + 20);
-        recs.draw(dfsTimeText);
+        //Draws the threshold slider and the result count field.
+        char thresholdLabel[32];
+        snprintf(thresholdLabel, sizeof(thresholdLabel), "Familiarity under %.2f", threshold);
+        Text thresholdText(thresholdLabel, font, 16);
+        thresholdText.setFillColor(Color::White);
+        setText(thresholdText, sliderX + sliderWidth / 2, sliderY - 22);
+        recs.draw(thresholdText);
+        recs.draw(sliderTrack);
+        sliderKnob.setPosition(sliderX + threshold * sliderWidth, sliderY);
+        recs.draw(sliderKnob);
+
+        Text countLabel("Results:", font, 16);
+        countLabel.setFillColor(Color::White);
+        setText(countLabel, 390, sliderY);
+        recs.draw(countLabel);
+        countField.setOutlineColor(editingCount ? Color(255, 215, 0) : Color::White);
+        recs.draw(countField);
+        Text countText(countInput, font, 18);
+        countText.setFillColor(Color::White);
+        setText(countText, 465, sliderY);
+        recs.draw(countText);
+
+        //Shows how long after the click the first frame of this window appeared, and how long the last change took.
+        if (firstFrameTime >= 0.0) {
+            Text firstFrameText("First frame " + to_string(static_cast<int>(firstFrameTime)) + " ms after click", font, 14);
+            firstFrameText.setFillColor(Color::White);
+            setText(firstFrameText, 640, 548);
+            recs.draw(firstFrameText);
+        }
+        if (updateTime >= 0.0) {
+            char updateLabel[48];
+            snprintf(updateLabel, sizeof(updateLabel), "Updated %.2f ms after change", updateTime);
+            Text updateText(updateLabel, font, 14);
+            updateText.setFillColor(Color::White);
+            setText(updateText, 640, 570);
+            recs.draw(updateText);
+        }
 
         recs.display();
+        if (firstFrameTime < 0.0) {
+            firstFrameTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - clickTime).count();
+        }
     }
 }
 
+//Stages of the background load, in order.
+enum class LoadStage { Catalog, Graph, Ready, Failed };
+
+//Progress channel between the loading thread and the welcome window...the loading thread writes it and the
+//window reads it every frame. The catalog and graph may only be touched once stage is Ready.
+struct LoadProgress {
+    atomic<LoadStage> stage{LoadStage::Catalog};
+    atomic<float> fraction{0.0f};
+
+    //progress through the whole load from 0 to 1, treating both stages as half the work.
+    [[nodiscard]] float getOverall() const {
+        float stageFraction = min(1.0f, fraction.load(memory_order_relaxed));
+        switch (stage.load(memory_order_acquire)) {
+            case LoadStage::Catalog:
+                return 0.5f * stageFraction;
+            case LoadStage::Graph:
+                return 0.5f + 0.5f * stageFraction;
+            default:
+                return 1.0f;
+        }
+    }
+};
+
 
 
-//main function.
-int main() {
+//main function...running with --build-snapshot converts the json file to a binary snapshot and exits,
+//running with --bench prints graph benchmarks for the featured genres and exits,
+//and --neighbors=N sets how many similar artists each artist is connected to.
+int main(int argc, char* argv[]) {
     //Creates graph and conditionals.
     bool isRunning = true;
     bool goBackToHome = false;
     Graph graph;
 
+    bool rebuildSnapshot = false;
+    bool benchmark = false;
+    string likedPath;
+    string pathEndpoints;
+    int neighborCount = defaultNeighborCount;
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument == "--build-snapshot") {
+            rebuildSnapshot = true;
+        } else if (argument == "--bench") {
+            benchmark = true;
+        } else if (argument.rfind("--path=", 0) == 0) {
+            pathEndpoints = argument.substr(7);
+        } else if (argument.rfind("--liked=", 0) == 0) {
+            likedPath = argument.substr(8);
+        } else if (argument.rfind("--neighbors=", 0) == 0) {
+            char* end = nullptr;
+            long count = strtol(argument.c_str() + 12, &end, 10);
+            if (end == argument.c_str() + 12 || *end != '\0' || count < 1 || count > maxNeighborCount) {
+                cerr << "--neighbors must be a whole number from 1 to " << maxNeighborCount << endl;
+                return 1;
+            }
+            neighborCount = static_cast<int>(count);
+        }
+    }
+
+    //Loads the data set once...every genre click is answered from the catalog afterwards.
+    ArtistCatalog catalog;
+
+    if (rebuildSnapshot || benchmark || !likedPath.empty() || !pathEndpoints.empty()) {
+        bool catalogLoaded = catalog.load("include/updated_music.json", "include/updated_music.snapshot", rebuildSnapshot);
+        if (rebuildSnapshot) {
+            if (!catalogLoaded) {
+                cerr << "Could not convert include/updated_music.json" << endl;
+                return 1;
+            }
+            cout << "Wrote include/updated_music.snapshot with " << catalog.getArtistCount() << " artists (" << catalog.getMemoryUsage() << " bytes) in "
+                 << catalog.getLoadTime() << " ms" << describeAllocations(catalog.getLoadAllocations()) << endl;
+            return 0;
+        }
+
+        if (!catalogLoaded) {
+            cerr << "Could not load include/updated_music.json" << endl;
+            return 1;
+        }
+        if (!likedPath.empty()) {
+            return recommendFromLiked(catalog, likedPath, neighborCount);
+        }
+        if (!pathEndpoints.empty()) {
+            return printPath(catalog, pathEndpoints, neighborCount);
+        }
+        runBenchmarks(catalog, neighborCount);
+        return 0;
+    }
+
+    //Loads the catalog and builds the similarity graph over every artist on a separate thread, so the welcome
+    //window keeps drawing and handling clicks while it runs.
+    LoadProgress loadProgress;
+    double graphTime = 0.0;
+    RecommendationCache recommendationCache;
+    thread loader([&]() {
+        if (!catalog.load("include/updated_music.json", "include/updated_music.snapshot", false, &loadProgress.fraction)) {
+            loadProgress.stage.store(LoadStage::Failed, memory_order_release);
+            return;
+        }
+        loadProgress.fraction.store(0.0f, memory_order_relaxed);
+        loadProgress.stage.store(LoadStage::Graph, memory_order_release);
+
+        auto startGraph = chrono::high_resolution_clock::now();
+        buildArtistGraph(catalog, graph, neighborCount, &loadProgress.fraction);
+        auto endGraph = chrono::high_resolution_clock::now();
+        graphTime = chrono::duration<double, milli>(endGraph - startGraph).count();
+
+        //precomputes every genre's recommendations so button clicks are cache lookups.
+        recommendationCache.warm(catalog, graph, defaultNicheThreshold, defaultRecommendationCount);
+        loadProgress.stage.store(LoadStage::Ready, memory_order_release);
+    });
+
     //Loading various textures and creating sprites.
     Texture button;
     button.loadFromFile("files/buttondepth.png");
@@ -340,6 +3825,101 @@ int main() {
 
     welcome.setFramerateLimit(60);
 
+    //Shows loading progress until the data is ready, then the startup cost of loading it.
+    Text loadStats("Loading artists...", font, 12);
+    loadStats.setFillColor(Color::White);
+    setText(loadStats, 400, 565);
+
+    RectangleShape loadBarBack(Vector2f(300, 6));
+    loadBarBack.setFillColor(Color(60, 80, 110));
+    loadBarBack.setPosition(250, 545);
+
+    RectangleShape loadBar(Vector2f(0, 6));
+    loadBar.setFillColor(Color::White);
+    loadBar.setPosition(250, 545);
+
+    //Shows the startup cost of loading the data set and how often genre clicks were answered from the cache.
+    auto updateLoadStats = [&]() {
+        string loadInfo;
+        if (catalog.isFromSnapshot()) {
+            loadInfo = "Mapped " + to_string(catalog.getArtistCount()) + " artists from the snapshot in " + to_string(static_cast<int>(catalog.getLoadTime())) +
+                       " ms (" + to_string(catalog.getMemoryUsage() / (1024 * 1024)) + " MB shared)";
+        } else {
+            loadInfo = "Loaded " + to_string(catalog.getArtistCount()) + " artists in " + to_string(static_cast<int>(catalog.getLoadTime())) +
+                       " ms at " + to_string(static_cast<int>(catalog.getThroughput())) + " MB/s (" +
+                       to_string(catalog.getMemoryUsage() / (1024 * 1024)) + " MB in memory)";
+        }
+        loadInfo += ", graph built in " + to_string(static_cast<int>(graphTime)) + " ms\n" + to_string(recommendationCache.getSize()) +
+                    " recommendations cached in " + to_string(static_cast<int>(recommendationCache.getWarmupTime())) + " ms (" +
+                    to_string(recommendationCache.getHits()) + " hits, " + to_string(recommendationCache.getMisses()) + " misses)";
+        loadStats.setString(loadInfo);
+        setText(loadStats, 400, 558);
+    };
+
+    //Updates the labels once the loading thread finishes...buttons show how many artists the genre index
+    //holds for each genre.
+    bool catalogLoaded = false;
+    bool loadFinished = false;
+    auto finishLoading = [&](LoadStage stage) {
+        loadFinished = true;
+        catalogLoaded = stage == LoadStage::Ready;
+        if (!catalogLoaded) {
+            loadStats.setString("Could not load include/updated_music.json");
+            setText(loadStats, 400, 565);
+            return;
+        }
+
+        auto genreLabel = [&](Text& text, const string& label, const string& genre, float x, float y) {
+            text.setString(label + " (" + to_string(catalog.getGenreSize(genre)) + ")");
+            setText(text, x, y);
+        };
+        genreLabel(hipHop, "Hip Hop", "hip hop", 195, 312);
+        genreLabel(folkRock, "Folk Rock", "folk rock", 195, 412);
+        genreLabel(popRock, "Pop Rock", "pop rock", 195, 512);
+        genreLabel(orchestra, "Orchestra", "orchestra", 595, 312);
+        genreLabel(rAndB, "R&B", "r&b", 595, 412);
+        genreLabel(country, "Country", "country", 595, 512);
+
+        updateLoadStats();
+    };
+
+    //Queries run on their own thread...activeQuery cancels the last one when a different genre is picked.
+    QueryExecutor executor;
+    CancelFlag activeQuery;
+
+    //Opens the recommendations window for a genre, which queues BFS, DFS and best-first straight away...returns false if the genre has no artists.
+    auto showRecommendations = [&](const string& selectedGenre) {
+        auto clickTime = chrono::high_resolution_clock::now();
+
+        //Starts from the first artist in the selected genre (terms)...its edges only lead to similar artists in the same genre.
+        uint32_t genre;
+        if (!catalog.findGenre(selectedGenre, genre) || catalog.getGenreMembers(genre).empty()) {
+            return false;
+        }
+        uint32_t first = *catalog.getGenreMembers(genre).begin();
+
+        //each new setting cancels whatever the last one left running.
+        auto submit = [&, genre, first](const vector<TraversalOrder>& orders, float threshold, uint32_t k) {
+            if (activeQuery) {
+                activeQuery->store(true, memory_order_relaxed);
+            }
+            activeQuery = make_shared<atomic<bool>>(false);
+            vector<future<TraversalResult>> queries;
+            for (TraversalOrder order : orders) {
+                RecommendationKey key{genre, order, {first, threshold, k}};
+                queries.push_back(submitRecommendation(executor, recommendationCache, graph, catalog, key, activeQuery));
+            }
+            return queries;
+        };
+
+        welcome.close();
+        displayRecommendations(submit, activeQuery, clickTime, goBackToHome);
+        return true;
+    };
+
+    //genre clicked before the data was ready...the latest click wins and runs as soon as loading finishes.
+    string queuedGenre;
+
     //Creates black border around window.
     float borderThickness = 15.0f;
     Color borderColor = sf::Color::Black;
@@ -380,49 +3960,33 @@ int main() {
                         selectedGenre = "country";
                     }
 
-                    if (!selectedGenre.empty()) {
-                        //Parsing data set.
-                        ifstream file("include/updated_music.json");
-                        json jsonData;
-                        file >> jsonData;
-                        file.close();
-
-                        //Set of unique artists.
-                        graph = Graph();
-                        unordered_set<string> seenArtists;
-
-                        //Adds artist to graph if it has the selected genre (terms) and is unique.
-                        for (const auto& item : jsonData) {
-                            string genre = item["artist"]["terms"].get<string>();
-                            string artistID = item["artist"]["id"];
-
-                            if (genre == selectedGenre && seenArtists.find(artistID) == seenArtists.end()) {
-                                graph.addArtist(artistID, item["artist"]);
-                                seenArtists.insert(artistID);
-                            }
-                        }
+                    if (!selectedGenre.empty() && !loadFinished) {
+                        queuedGenre = selectedGenre;
+                        loadStats.setString("Loading artists...recommendations for " + selectedGenre + " will open when ready");
+                        setText(loadStats, 400, 565);
+                    } else if (!selectedGenre.empty() && catalogLoaded) {
+                        showRecommendations(selectedGenre);
+                    }
+                }
+            }
 
-                        //Adding edges.
-                        vector<string> ids = graph.getIDs();
-                        for (size_t i = 0; i < ids.size(); ++i) {
-                            for (size_t j = i + 1; j < ids.size(); ++j) {
-                                graph.addEdge(ids[i], ids[j]);
-                            }
+            //Checks on the loading thread once per frame and runs a queued click as soon as the data is ready.
+            if (!loadFinished) {
+                LoadStage stage = loadProgress.stage.load(memory_order_acquire);
+                if (stage == LoadStage::Ready || stage == LoadStage::Failed) {
+                    finishLoading(stage);
+                    if (catalogLoaded && !queuedGenre.empty()) {
+                        string genre = move(queuedGenre);
+                        queuedGenre.clear();
+                        if (showRecommendations(genre)) {
+                            continue;
                         }
-
-                        //Getting traversal times.
-                        auto startBfs = chrono::high_resolution_clock::now();
-                        vector<string> bfsResults = graph.BFS(ids[0]);
-                        auto endBfs = chrono::high_resolution_clock::now();
-                        double bfsTime = chrono::duration<double, milli>(endBfs - startBfs).count();
-
-                        auto startDfs = chrono::high_resolution_clock::now();
-                        vector<string> dfsResults = graph.DFS(ids[0]);
-                        auto endDfs = chrono::high_resolution_clock::now();
-                        double dfsTime = chrono::duration<double, milli>(endDfs - startDfs).count();
-
-                        welcome.close();
-                        displayRecommendations(bfsResults, dfsResults, bfsTime, dfsTime, goBackToHome);
+                    }
+                } else {
+                    loadBar.setSize(Vector2f(300 * loadProgress.getOverall(), 6));
+                    if (queuedGenre.empty()) {
+                        loadStats.setString(stage == LoadStage::Catalog ? "Loading artists..." : "Building the artist graph...");
+                        setText(loadStats, 400, 565);
                     }
                 }
             }
@@ -445,16 +4009,23 @@ int main() {
             welcome.draw(rAndB);
             welcome.draw(countryButton);
             welcome.draw(country);
+            welcome.draw(loadStats);
+            if (!loadFinished) {
+                welcome.draw(loadBarBack);
+                welcome.draw(loadBar);
+            }
             welcome.display();
         }
 
         //Handles home button.
         if (goBackToHome) {
             goBackToHome = false;
+            updateLoadStats();
             welcome.create(VideoMode(800, 600), "Underground Artists", Style::Close);
         }
     }
 
+    loader.join();
     return 0;
 }
 